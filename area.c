@@ -0,0 +1,220 @@
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "area.h"
+#include "spatial.h"
+#include "schedule.h"
+#include "status.h"
+#include "utils.h"
+
+/** The eight directions a cone can face, in the order they're kept. */
+static const int directions[8][2] = {
+	{0, -1}, {1, -1}, {1, 0}, {1, 1},
+	{0, 1}, {-1, 1}, {-1, 0}, {-1, -1}
+};
+
+/** Bursts, by radius. */
+static AreaShape bursts[AREA_MAX_RADIUS + 1];
+
+/** Cones, by radius and direction. */
+static AreaShape cones[AREA_MAX_RADIUS + 1][8];
+
+/** Work out the shapes just once, whichever thread gets there first. */
+static pthread_once_t shapes_made = PTHREAD_ONCE_INIT;
+
+/**
+ * Add an offset to a shape.
+ * @param shape The shape
+ * @param dx The X offset
+ * @param dy The Y offset
+ */
+static void add_offset(AreaShape * shape, int dx, int dy) {
+	shape->mask[dx + AREA_MAX_RADIUS][dy + AREA_MAX_RADIUS] = true;
+}
+
+/**
+ * Work out every shape. A burst is every cell within its radius (but
+ * not the middle); a cone is the cells of a burst within 45 degrees
+ * of the way it faces.
+ */
+static void make_shapes(void) {
+	for(int radius = 1; radius <= AREA_MAX_RADIUS; radius++) {
+		bursts[radius].radius = radius;
+		for(int d = 0; d < 8; d++) {
+			cones[radius][d].radius = radius;
+		}
+
+		for(int dx = -radius; dx <= radius; dx++) {
+			for(int dy = -radius; dy <= radius; dy++) {
+				/* Round the circle out a little, so it isn't spiky */
+				if((dx == 0 && dy == 0) || dx * dx + dy * dy > radius * radius + radius) {
+					continue;
+				}
+
+				add_offset(&bursts[radius], dx, dy);
+
+				for(int d = 0; d < 8; d++) {
+					int fx = directions[d][0];
+					int fy = directions[d][1];
+					int dot = dx * fx + dy * fy;
+
+					/* cos(angle) >= cos(45), squared to keep to integers */
+					if(dot > 0 && 2 * dot * dot >= (dx * dx + dy * dy) * (fx * fx + fy * fy)) {
+						add_offset(&cones[radius][d], dx, dy);
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * The shape of a burst around a point.
+ * @param radius The radius (at most AREA_MAX_RADIUS)
+ */
+static const AreaShape * burst_shape(unsigned int radius) {
+	pthread_once(&shapes_made, &make_shapes);
+
+	if(radius > AREA_MAX_RADIUS) {
+		radius = AREA_MAX_RADIUS;
+	}
+	return &bursts[radius];
+}
+
+/**
+ * The shape of a cone from a point.
+ * @param radius The radius (at most AREA_MAX_RADIUS)
+ * @param dx The X of the way it faces (only the sign matters)
+ * @param dy The Y of the way it faces (only the sign matters)
+ */
+static const AreaShape * cone_shape(unsigned int radius, int dx, int dy) {
+	pthread_once(&shapes_made, &make_shapes);
+
+	if(radius > AREA_MAX_RADIUS) {
+		radius = AREA_MAX_RADIUS;
+	}
+
+	dx = (dx > 0) - (dx < 0);
+	dy = (dy > 0) - (dy < 0);
+
+	for(unsigned int d = 0; d < 8; d++) {
+		if(directions[d][0] == dx && directions[d][1] == dy) {
+			return &cones[radius][d];
+		}
+	}
+
+	return &bursts[0];
+}
+
+/**
+ * The shape a weapon which hits an area makes, aimed at an offset.
+ * @param weapon The weapon
+ * @param dx The X offset aimed at
+ * @param dy The Y offset aimed at
+ */
+static const AreaShape * weapon_shape(const Item * weapon, int dx, int dy) {
+	return (weapon->area == AREA_CONE)
+		? cone_shape(weapon->area_radius, dx, dy)
+		: burst_shape(weapon->area_radius);
+}
+
+/**
+ * Check if a mob's weapon which hits an area would hit a point, if
+ * aimed at it (ignoring anything in the way).
+ * @param attacker The mob, which must have a weapon which hits an area
+ * @param x The X of the point
+ * @param y The Y of the point
+ */
+bool area_reaches(Mob * attacker, unsigned int x, unsigned int y) {
+	int dx = (int) x - (int) mob_xpos(attacker);
+	int dy = (int) y - (int) mob_ypos(attacker);
+	const AreaShape * shape = weapon_shape(attacker->weapon, dx, dy);
+
+	return abs(dx) <= (int) shape->radius && abs(dy) <= (int) shape->radius &&
+		shape->mask[dx + AREA_MAX_RADIUS][dy + AREA_MAX_RADIUS];
+}
+
+/**
+ * Find the mobs an area hits: those in the shape which can be seen
+ * from where it starts. Only the mobs near enough to be in it are
+ * looked at, rather than every cell of it.
+ * @param attacker The mob the area comes from, which isn't hit
+ * @param x The X the area starts from
+ * @param y The Y the area starts from
+ * @param shape The shape
+ * @param hit Where to write the mobs hit
+ * @param max_hit The most mobs to write
+ * @return The number of mobs hit
+ */
+unsigned int area_hit(Mob * attacker, unsigned int x, unsigned int y,
+                      const AreaShape * shape,
+                      Mob ** hit, unsigned int max_hit) {
+	Level * level = attacker->level;
+	Mob * near[AREA_SPAN * AREA_SPAN];
+	unsigned int num_near = mobs_near(level, x, y, shape->radius, near, lengthof(near));
+	unsigned int count = 0;
+
+	for(unsigned int i = 0; i < num_near && count < max_hit; i++) {
+		Mob * mob = near[i];
+		int dx = (int) mob_xpos(mob) - (int) x;
+		int dy = (int) mob_ypos(mob) - (int) y;
+
+		if(mob != attacker && mob_health(mob) > 0 &&
+		   shape->mask[dx + AREA_MAX_RADIUS][dy + AREA_MAX_RADIUS] &&
+		   can_see_point(level, x, y, mob_xpos(mob), mob_ypos(mob))) {
+			hit[count ++] = mob;
+		}
+	}
+
+	return count;
+}
+
+/**
+ * Attack with a weapon which hits an area, aimed at a mob. Everything
+ * the area hits is rolled for first, then damaged, then has the fight
+ * effects (such as burning) applied, so what dies part way through
+ * doesn't change what happens to the rest.
+ * @param attacker The mob doing the attacking
+ * @param defender The mob aimed at
+ */
+void area_attack(Mob * attacker, Mob * defender) {
+	Item * weapon = attacker->weapon;
+	unsigned int x = mob_xpos(attacker);
+	unsigned int y = mob_ypos(attacker);
+	const AreaShape * shape = weapon_shape(weapon,
+	                                       (int) mob_xpos(defender) - (int) x,
+	                                       (int) mob_ypos(defender) - (int) y);
+
+	Mob * hit[AREA_SPAN * AREA_SPAN];
+	int damage[AREA_SPAN * AREA_SPAN];
+	unsigned int count = area_hit(attacker, x, y, shape, hit, lengthof(hit));
+
+	charge_action(attacker, ACTION_ATTACK);
+
+	for(unsigned int i = 0; i < count; i++) {
+		damage[i] = roll_damage(attacker, hit[i]);
+	}
+
+	for(unsigned int i = 0; i < count; i++) {
+		damage_mob(hit[i], (unsigned int) damage[i]);
+	}
+
+	for(unsigned int i = 0; i < count; i++) {
+		fight_effects(attacker, weapon, hit[i], damage[i]);
+	}
+
+	/* Update the status */
+	Mob * player = attacker->level->player;
+	if(attacker == player) {
+		status_push("Your %s hits %u %s.", weapon->name, count,
+		            (count == 1) ? "thing" : "things");
+		return;
+	}
+
+	for(unsigned int i = 0; i < count; i++) {
+		if(hit[i] == player) {
+			status_push("The %s's %s hits you for %d damage!",
+			            attacker->name, weapon->name, damage[i]);
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#ifndef AREA_H
+#define AREA_H
+
+#include <stdbool.h>
+
+#include "mob.h"
+#include "level.h"
+
+/** The furthest an area can reach. */
+#define AREA_MAX_RADIUS 4
+
+/** The width (and height) of the square any area fits in. */
+#define AREA_SPAN (2 * AREA_MAX_RADIUS + 1)
+
+/**
+ * The shape of an area, as a mask of the offsets of the cells in it
+ * from where it starts, so whether a cell is in the shape can be
+ * looked up directly.
+ */
+typedef struct AreaShape {
+	unsigned int radius;             /**< The furthest any cell is. */
+	bool mask[AREA_SPAN][AREA_SPAN]; /**< Whether each offset (plus AREA_MAX_RADIUS) is in it. */
+} AreaShape;
+
+unsigned int area_hit(Mob * attacker, unsigned int x, unsigned int y,
+                      const AreaShape * shape,
+                      Mob ** hit, unsigned int max_hit);
+bool area_reaches(Mob * attacker, unsigned int x, unsigned int y);
+void area_attack(Mob * attacker, Mob * defender);
+
+#endif /* AREA_H */
@@ -0,0 +1,256 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "astar.h"
+#include "utils.h"
+
+/** The neighbours of a cell, orthogonal ones first. */
+static const int neighbours[8][2] = {
+	{0, -1}, {0, 1}, {-1, 0}, {1, 0},
+	{-1, -1}, {1, -1}, {-1, 1}, {1, 1}
+};
+
+/**
+ * The storage for path searches made by the mobs of a level, one at
+ * a time, as they take their turns.
+ * @param level The level
+ */
+PathFinder * level_path_finder(Level * level) {
+	if(level->pathfinder == NULL) {
+		level->pathfinder = xalloc(PathFinder);
+	}
+
+	return level->pathfinder;
+}
+
+/**
+ * Walking: open cells cost 1, solid ones can't be entered.
+ * @param level The level
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ * @param data Unused
+ */
+int path_walk_cost(Level * level, unsigned int x, unsigned int y, void * data) {
+	(void) data;
+	return level->cells[x][y]->solid ? PATH_BLOCKED : 1;
+}
+
+/**
+ * Walking with something to dig with: as walking, but rock (other
+ * than at the edge of the level) can be dug through for
+ * PATH_DIG_COST.
+ * @param level The level
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ * @param data Unused
+ */
+int path_dig_cost(Level * level, unsigned int x, unsigned int y, void * data) {
+	(void) data;
+	Cell * cell = level->cells[x][y];
+
+	if(!cell->solid) {
+		return 1;
+	} else if(cell->baseSymbol == '#' &&
+	          x > 0 && y > 0 && x < LEVELWIDTH - 1 && y < LEVELHEIGHT - 1) {
+		return PATH_DIG_COST;
+	} else {
+		return PATH_BLOCKED;
+	}
+}
+
+/**
+ * Whether one open node should come out before another: lowest
+ * estimate first, and of those, the one furthest along.
+ * @param finder The finder
+ * @param a The first node
+ * @param b The second node
+ */
+static bool before(const PathFinder * finder, unsigned int a, unsigned int b) {
+	return finder->estimate[a] < finder->estimate[b] ||
+		(finder->estimate[a] == finder->estimate[b] && finder->cost[a] > finder->cost[b]);
+}
+
+/**
+ * Put a node in its place in the open heap.
+ * @param finder The finder
+ * @param node The node
+ * @param i Where it is now
+ */
+static void sift_up(PathFinder * finder, unsigned int node, unsigned int i) {
+	while(i > 0) {
+		unsigned int parent = (i - 1) / 2;
+		if(!before(finder, node, finder->open[parent])) {
+			break;
+		}
+
+		finder->open[i] = finder->open[parent];
+		finder->position[finder->open[i]] = i;
+		i = parent;
+	}
+
+	finder->open[i] = node;
+	finder->position[node] = i;
+}
+
+/**
+ * Take the best node out of the open heap.
+ * @param finder The finder
+ */
+static unsigned int pop_open(PathFinder * finder) {
+	unsigned int best = finder->open[0];
+	unsigned int node = finder->open[-- finder->num_open];
+	unsigned int i = 0;
+
+	for(;;) {
+		unsigned int child = 2 * i + 1;
+		if(child >= finder->num_open) {
+			break;
+		}
+		if(child + 1 < finder->num_open &&
+		   before(finder, finder->open[child + 1], finder->open[child])) {
+			child ++;
+		}
+		if(!before(finder, finder->open[child], node)) {
+			break;
+		}
+
+		finder->open[i] = finder->open[child];
+		finder->position[finder->open[i]] = i;
+		i = child;
+	}
+
+	if(finder->num_open > 0) {
+		finder->open[i] = node;
+		finder->position[node] = i;
+	}
+
+	return best;
+}
+
+/**
+ * The estimated cost of getting from one cell to another, which must
+ * never be more than the real cost.
+ * @param options The search options
+ * @param dx The X distance
+ * @param dy The Y distance
+ */
+static int estimate(const PathOptions * options, int dx, int dy) {
+	dx = abs(dx);
+	dy = abs(dy);
+
+	int steps = options->diagonal ? ((dx > dy) ? dx : dy) : dx + dy;
+	return steps * ((options->min_cost > 1) ? options->min_cost : 1);
+}
+
+/**
+ * Find the cheapest path between two cells with A*.
+ * @param finder The storage to search with
+ * @param level The level
+ * @param startx The X to start from
+ * @param starty The Y to start from
+ * @param goalx The X to get to
+ * @param goaly The Y to get to
+ * @param options How to search (NULL for orthogonal walking)
+ * @param steps Where to write the steps of the path (may be NULL)
+ * @param max_steps The most steps to write; longer paths are cut short
+ * @return The length of the whole path, or PATH_NONE if there isn't one
+ */
+unsigned int find_path(PathFinder * finder, Level * level,
+                       unsigned int startx, unsigned int starty,
+                       unsigned int goalx, unsigned int goaly,
+                       const PathOptions * options,
+                       PathStep * steps, unsigned int max_steps) {
+	static const PathOptions walking = {.diagonal = false, .cost = NULL, .data = NULL, .min_cost = 1};
+	if(options == NULL) {
+		options = &walking;
+	}
+	PathCost cost = (options->cost == NULL) ? &path_walk_cost : options->cost;
+	unsigned int num_neighbours = options->diagonal ? 8 : 4;
+
+	/* A new search number makes every node unseen; only when the
+	   numbers run out do the marks need clearing */
+	finder->search ++;
+	if(finder->search == 0) {
+		memset(finder->seen, 0, sizeof(finder->seen));
+		memset(finder->closed, 0, sizeof(finder->closed));
+		finder->search = 1;
+	}
+
+	unsigned int start = startx * LEVELHEIGHT + starty;
+	unsigned int goal = goalx * LEVELHEIGHT + goaly;
+
+	finder->seen[start] = finder->search;
+	finder->cost[start] = 0;
+	finder->estimate[start] = estimate(options, (int) goalx - (int) startx, (int) goaly - (int) starty);
+	finder->num_open = 0;
+	sift_up(finder, start, finder->num_open ++);
+
+	while(finder->num_open > 0) {
+		unsigned int node = pop_open(finder);
+		finder->closed[node] = finder->search;
+
+		if(node == goal) {
+			break;
+		}
+
+		unsigned int x = node / LEVELHEIGHT;
+		unsigned int y = node % LEVELHEIGHT;
+
+		for(unsigned int i = 0; i < num_neighbours; i++) {
+			int nx = x + neighbours[i][0];
+			int ny = y + neighbours[i][1];
+
+			if(nx < 0 || ny < 0 || nx >= LEVELWIDTH || ny >= LEVELHEIGHT) {
+				continue;
+			}
+
+			unsigned int next = nx * LEVELHEIGHT + ny;
+			if(finder->closed[next] == finder->search) {
+				continue;
+			}
+
+			int step = cost(level, nx, ny, options->data);
+			if(step == PATH_BLOCKED) {
+				continue;
+			}
+
+			int total = finder->cost[node] + step;
+			if(finder->seen[next] == finder->search && total >= finder->cost[next]) {
+				continue;
+			}
+
+			finder->cost[next] = total;
+			finder->estimate[next] = total + estimate(options, (int) goalx - nx, (int) goaly - ny);
+			finder->parent[next] = node;
+
+			if(finder->seen[next] == finder->search) {
+				sift_up(finder, next, finder->position[next]);
+			} else {
+				finder->seen[next] = finder->search;
+				sift_up(finder, next, finder->num_open ++);
+			}
+		}
+	}
+
+	if(finder->closed[goal] != finder->search) {
+		return PATH_NONE;
+	}
+
+	/* Count the path, then write out its start walking back from the goal */
+	unsigned int length = 0;
+	for(unsigned int node = goal; node != start; node = finder->parent[node]) {
+		length ++;
+	}
+
+	unsigned int i = length;
+	for(unsigned int node = goal; node != start; node = finder->parent[node]) {
+		i --;
+		if(steps != NULL && i < max_steps) {
+			unsigned int parent = finder->parent[node];
+			steps[i].dx = (int) (node / LEVELHEIGHT) - (int) (parent / LEVELHEIGHT);
+			steps[i].dy = (int) (node % LEVELHEIGHT) - (int) (parent % LEVELHEIGHT);
+		}
+	}
+
+	return length;
+}
@@ -0,0 +1,72 @@
+#ifndef ASTAR_H
+#define ASTAR_H
+
+#include <stdbool.h>
+
+#include "level.h"
+
+/** The number of nodes in a search: one per cell. */
+#define PATH_NODES (LEVELWIDTH * LEVELHEIGHT)
+
+/** The cost of a step which can't be taken. */
+#define PATH_BLOCKED -1
+
+/** The cost of digging through a rock with path_dig_cost. */
+#define PATH_DIG_COST 4
+
+/** The length returned when there is no path. */
+#define PATH_NONE ((unsigned int) -1)
+
+/**
+ * The cost of stepping into a cell, or PATH_BLOCKED.
+ */
+typedef int (*PathCost)(Level * level, unsigned int x, unsigned int y, void * data);
+
+/**
+ * How a path is to be found.
+ */
+typedef struct PathOptions {
+	bool diagonal;  /**< Whether diagonal steps are allowed. */
+	PathCost cost;  /**< The cost of each step (NULL for path_walk_cost). */
+	void * data;    /**< Passed to the cost function. */
+	int min_cost;   /**< The least a step can cost, which the estimate of the remaining cost is scaled by (at least 1). */
+} PathOptions;
+
+/**
+ * One step of a path.
+ */
+typedef struct PathStep {
+	int dx; /**< The X offset (in [-1,0,1]) */
+	int dy; /**< The Y offset (in [-1,0,1]) */
+} PathStep;
+
+/**
+ * The working storage for A* searches, with a node for every cell,
+ * which is reused from one search to the next: nodes are marked with
+ * the number of the search which last touched them, so nothing needs
+ * clearing, and searching allocates nothing. One PathFinder can only
+ * run one search at a time. A zeroed PathFinder is ready to use.
+ */
+typedef struct PathFinder {
+	unsigned int search;             /**< The number of the current search. */
+	unsigned int seen[PATH_NODES];   /**< The search in which each node was reached. */
+	unsigned int closed[PATH_NODES]; /**< The search in which each node was settled. */
+	int cost[PATH_NODES];            /**< The cost of reaching each node. */
+	int estimate[PATH_NODES];        /**< That plus the estimated cost to go. */
+	unsigned int parent[PATH_NODES]; /**< The node each was reached from. */
+
+	unsigned int open[PATH_NODES];   /**< The open nodes, as a binary heap. */
+	unsigned int position[PATH_NODES]; /**< Where each open node is in the heap. */
+	unsigned int num_open;           /**< The number of open nodes. */
+} PathFinder;
+
+PathFinder * level_path_finder(Level * level);
+int path_walk_cost(Level * level, unsigned int x, unsigned int y, void * data);
+int path_dig_cost(Level * level, unsigned int x, unsigned int y, void * data);
+unsigned int find_path(PathFinder * finder, Level * level,
+                       unsigned int startx, unsigned int starty,
+                       unsigned int goalx, unsigned int goaly,
+                       const PathOptions * options,
+                       PathStep * steps, unsigned int max_steps);
+
+#endif /* ASTAR_H */
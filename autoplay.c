@@ -1,13 +1,17 @@
 #ifdef AUTOPLAY
 #include <stdlib.h>
 #include <stdbool.h>
-#include <math.h>
 
 #include "autoplay.h"
 #include "item.h"
 #include "player.h"
 #include "mob.h"
 #include "level.h"
+#include "astar.h"
+#include "regions.h"
+#include "spatial.h"
+#include "utils.h"
+#include "rng.h"
 
 const void ** autoplay_list_choice(const char * choices[],
 				   const void * results[]){
@@ -23,101 +27,148 @@ const void ** autoplay_list_choice(const char * choices[],
 static char opening_moves[] = {'w','x','w','x','W'};
 static unsigned int move_count = 0;
 
+// random moves come from a stream of their own, so a seeded game
+// plays out the same
+static Rng autoplay_rng;
+
 // get the cell at an offset from the player
 static Cell * cell_at(Mob * player, int dx, int dy) {
-  return player->level->cells[player->xpos + dx][player->ypos + dy];
+  return player->level->cells[mob_xpos(player) + dx][mob_ypos(player) + dy];
 }
 
 // move into an enemy if there is one
 static bool find_enemy(Mob * player, Direction * out) {
-  for (int dx = -1; dx <= 1; dx ++) {
-    for (int dy = -1; dy <= 1; dy ++) {
-      Cell * cell = cell_at(player, dx, dy);
-      if(cell->occupant != NULL && cell->occupant != player) {
-        out->dx = dx;
-        out->dy = dy;
-        return true;
-      }
+  Mob * nearby[9];
+  unsigned int count = mobs_near(player->level, mob_xpos(player), mob_ypos(player), 1,
+                                 nearby, lengthof(nearby));
+
+  for (unsigned int i = 0; i < count; i ++) {
+    if(nearby[i] != player) {
+      out->dx = mob_xpos(nearby[i]) - mob_xpos(player);
+      out->dy = mob_ypos(nearby[i]) - mob_ypos(player);
+      return true;
     }
   }
   return false;
 }
 
-static int path_dx[32] = {0};
-static int path_dy[32] = {0};
+// the planned path to the stairs, which is kept until it stops being
+// any good
+static PathStep * path = NULL;
+static unsigned int path_capacity = 0;
+static unsigned int path_length = 0;
 static unsigned int path_pos = 0;
-static unsigned int path_maxpos = 32;
 
-// distance between two points
-static float distance(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) {
-  float dx = (float)x1 - (float)x2;
-  float dy = (float)y1 - (float)y2;
+// where the player should be before taking the next step
+static unsigned int path_x = 0;
+static unsigned int path_y = 0;
+
+// what the path was planned for: if none of this has changed, neither
+// has the path
+static Level * path_level = NULL;
+static unsigned long path_epoch = 0;
+static bool path_digging = false;
+static bool path_found = false;
 
-  return sqrt(dx * dx + dy * dy);
+// whether the player can dig through rock
+static bool can_dig(Mob * player) {
+  return player->weapon != NULL && player->weapon->can_dig;
 }
 
-// simple greedy parthfinding algorithm
-static void greedy_pathfind(Mob * player, unsigned int tx, unsigned int ty, unsigned int cx, unsigned int cy) {
-  // check for termination
-  if ((cx == tx && cy == ty) || path_pos == path_maxpos) {
-    path_dx[path_pos] = 0;
-    path_dy[path_pos] = 0;
-    path_pos = 0;
+// plan a path to the stairs down, digging if possible
+static void plan_path(Mob * player) {
+  Level * level = player->level;
+  PathOptions options = {
+    .diagonal = true,
+    .cost = can_dig(player) ? &path_dig_cost : &path_walk_cost
+  };
+
+  path_level = level;
+  path_epoch = level->terrain_epoch;
+  path_digging = can_dig(player);
+  path_pos = 0;
+  path_x = mob_xpos(player);
+  path_y = mob_ypos(player);
+
+  // grow the buffer until the whole path fits
+  for(;;) {
+    path_length = find_long_path(level_path_finder(level), level,
+                                 path_x, path_y, level->endx, level->endy,
+                                 &options, path, path_capacity);
+    if(path_length == PATH_NONE || path_length <= path_capacity) {
+      break;
+    }
 
-    return;
+    path_capacity = path_length * 2;
+    path = xrealloc(path, path_capacity, PathStep);
   }
 
-  // pick the next move: don't undo the last move, if there are no
-  // better (known empty) places than the current one, terminate.
-  int dx = 0;
-  int dy = 0;
-
-  float dist = distance(tx, ty, cx, cy);
-
-  for (int xoff = -1; xoff <= 1; xoff ++) {
-    if (cx == 0 && xoff == -1) continue;
-    if (cx == LEVELWIDTH && xoff == 1) continue;
+  path_found = (path_length != PATH_NONE);
+}
 
-    for (int yoff = -1; yoff <= 1; yoff ++) {
-      if (cy == 0 && yoff == -1) continue;
-      if (cy == LEVELHEIGHT && yoff == 1) continue;
+// whether the rest of the path can still be followed, after the
+// terrain has changed
+static bool path_still_clear(Mob * player) {
+  PathCost cost = path_digging ? &path_dig_cost : &path_walk_cost;
+  unsigned int x = path_x;
+  unsigned int y = path_y;
 
-      if(player->level->cells[cx + xoff][cy + yoff]->solid)
-        continue;
+  for(unsigned int i = path_pos; i < path_length; i++) {
+    x += path[i].dx;
+    y += path[i].dy;
 
-      float new_dist = distance(tx, ty, cx + xoff, cy + yoff);
-      if(new_dist < dist) {
-        dx = xoff;
-        dy = yoff;
-        dist = new_dist;
-      }
+    if(cost(player->level, x, y, NULL) == PATH_BLOCKED) {
+      return false;
     }
   }
 
-  if (dx == 0 && dy == 0) {
-    // no move found, terminate
-    path_dx[path_pos] = 0;
-    path_dy[path_pos] = 0;
-    path_pos = 0;
-  } else {
-    // record the move
-    path_dx[path_pos] = dx;
-    path_dy[path_pos] = dy;
+  return true;
+}
+
+// the next step along the path to the stairs, replanning only if the
+// level, the terrain along the path or the ability to dig has changed
+static bool follow_path(Mob * player, Direction * out) {
+  Level * level = player->level;
+
+  // catch up with the last step, if it was taken (digging may take a
+  // few goes)
+  if(path_found && path_pos < path_length &&
+     mob_xpos(player) == path_x + path[path_pos].dx &&
+     mob_ypos(player) == path_y + path[path_pos].dy) {
+    path_x = mob_xpos(player);
+    path_y = mob_ypos(player);
     path_pos ++;
+  }
 
-    greedy_pathfind(player, tx, ty, cx + dx, cy + dy);
+  if(path_level != level || path_digging != can_dig(player) ||
+     (path_found && (mob_xpos(player) != path_x || mob_ypos(player) != path_y ||
+                     path_pos == path_length))) {
+    plan_path(player);
+  } else if(path_epoch != level->terrain_epoch) {
+    // no path might now have become one, and a path might now be
+    // blocked; mobs in the way are fought rather than planned round
+    if(!path_found || !path_still_clear(player)) {
+      plan_path(player);
+    }
+    path_epoch = level->terrain_epoch;
   }
-}
 
-// find a path from the current point.
-static void pathfind(Mob * player, unsigned int tx, unsigned int ty) {
-  path_pos = 0;
-  greedy_pathfind(player, tx, ty, player->xpos, player->ypos);
+  if(!path_found || path_pos == path_length) {
+    return false;
+  }
+
+  out->dx = path[path_pos].dx;
+  out->dy = path[path_pos].dy;
+  return true;
 }
 
 Direction autoplay_select_direction(Mob * player){
   Direction out = {.dx = 0, .dy = 0, .ch = 0};
 
+  if(move_count == 0) {
+    rng_stream(&autoplay_rng, RNG_AUTOPLAY, 0);
+  }
+
   // perform a standard set of moves to begin with
   if(move_count < sizeof(opening_moves)){
     out.ch = opening_moves[move_count];
@@ -136,29 +187,17 @@ Direction autoplay_select_direction(Mob * player){
     return out;
   }
 
-  // if no path to follow, or following would hit a wall (why does
-  // this happen?) move randomly now and then pathfind for later.
-  if((path_dx[path_pos] == 0 && path_dy[path_pos] == 0) || cell_at(player, path_dx[path_pos], path_dy[path_pos])->solid) {
-    // move randomly
-    do {
-      out.dx = (rand() % 3) - 1;
-      out.dy = (rand() % 3) - 1;
-    }
-    while(cell_at(player, out.dx, out.dy)->solid);
-
-    // pathfind
-    for(unsigned int x = 1; x < LEVELWIDTH; x++) {
-      for(unsigned int y = 1; y < LEVELHEIGHT; y++) {
-        if(player->level->cells[x][y]->baseSymbol == '>') {
-          pathfind(player, x, y);
-        }
-      }
-    }
-  } else {
-    out.dx = path_dx[path_pos];
-    out.dy = path_dy[path_pos];
-    path_pos ++;
+  // follow the path to the stairs
+  if(follow_path(player, &out)) {
+    return out;
+  }
+
+  // there's no way to the stairs: move randomly
+  do {
+    out.dx = (int) rng_below(&autoplay_rng, 3) - 1;
+    out.dy = (int) rng_below(&autoplay_rng, 3) - 1;
   }
+  while(cell_at(player, out.dx, out.dy)->solid);
 
   return out;
 }
@@ -0,0 +1,99 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "background.h"
+#include "level.h"
+
+/**
+ * The most recently visited levels, most recent first. The first is
+ * the level the player is on, which never runs in the background.
+ */
+static Level * recent[BACKGROUND_LEVELS + 1];
+
+/** The workers ticking the background levels. */
+static pthread_t workers[BACKGROUND_LEVELS];
+
+/** Whether each worker is running. */
+static bool running[BACKGROUND_LEVELS];
+
+/** The number of turns since the last background tick. */
+static unsigned int turns = 0;
+
+/**
+ * Note that the player is on a level, making it the most recent.
+ * @param level The level the player is on
+ */
+void background_visit(Level * level) {
+	if(recent[0] == level) {
+		return;
+	}
+
+	/* Shuffle everything more recent than the level's old position
+	   (or everything, if it's new) down one */
+	unsigned int i;
+	for(i = 1; i < BACKGROUND_LEVELS + 1 && recent[i] != level; i++);
+	if(i == BACKGROUND_LEVELS + 1) {
+		i = BACKGROUND_LEVELS;
+	}
+
+	for(; i > 0; i--) {
+		recent[i] = recent[i - 1];
+	}
+	recent[0] = level;
+}
+
+/**
+ * Tick a background level, unless the player has arrived in it since
+ * the tick was started. Workers run alongside each other and the
+ * player's level, so everything random in a tick must come from the
+ * level's own streams (level_rng), never a shared generator.
+ * @param arg The level
+ */
+static void * tick_level(void * arg) {
+	Level * level = (Level *) arg;
+
+	pthread_mutex_lock(&level->lock);
+	if(level->player == NULL) {
+		run_background_turn(level, BACKGROUND_INTERVAL);
+	}
+	pthread_mutex_unlock(&level->lock);
+
+	return NULL;
+}
+
+/**
+ * Start ticking the recently visited levels, if one is due. Every
+ * BACKGROUND_INTERVAL turns, each level gets one coarse tick, on its
+ * own thread, while the main thread runs the player's level.
+ */
+void background_start(void) {
+	turns ++;
+	if(turns < BACKGROUND_INTERVAL) {
+		return;
+	}
+	turns = 0;
+
+	for(unsigned int i = 0; i < BACKGROUND_LEVELS; i++) {
+		Level * level = recent[i + 1];
+		running[i] = (level != NULL) &&
+			(pthread_create(&workers[i], NULL, &tick_level, level) == 0);
+
+		/* If there are no threads to be had, just do it now */
+		if(level != NULL && !running[i]) {
+			tick_level(level);
+		}
+	}
+}
+
+/**
+ * Wait for any background ticks to finish.
+ */
+void background_finish(void) {
+	for(unsigned int i = 0; i < BACKGROUND_LEVELS; i++) {
+		if(running[i]) {
+			pthread_join(workers[i], NULL);
+			running[i] = false;
+		}
+	}
+}
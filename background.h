@@ -0,0 +1,16 @@
+#ifndef BACKGROUND_H
+#define BACKGROUND_H
+
+#include "level.h"
+
+/** The number of recently visited levels which keep running. */
+#define BACKGROUND_LEVELS 3
+
+/** The number of turns covered by each background tick. */
+#define BACKGROUND_INTERVAL 4
+
+void background_visit(Level * level);
+void background_start(void);
+void background_finish(void);
+
+#endif /* BACKGROUND_H */
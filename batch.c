@@ -0,0 +1,129 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "batch.h"
+#include "enemy.h"
+#include "behaviour.h"
+#include "schedule.h"
+#include "distmap.h"
+#include "utils.h"
+
+extern bool quit;
+
+/** The enemies waiting to act, in the order they act. */
+static Mob ** batch = NULL;
+
+/** The generator each enemy decides with. */
+static Rng * rngs = NULL;
+
+/** What each enemy has decided to do. */
+static Intent * intents = NULL;
+
+/** The number of enemies in the batch. */
+static unsigned int count = 0;
+
+/** The size of the batch arrays. */
+static unsigned int capacity = 0;
+
+/** The storage each thread searches for paths with. */
+static PathFinder finders[BATCH_THREADS];
+
+/**
+ * A share of a batch to decide on one thread.
+ */
+typedef struct Chunk {
+	unsigned int start; /**< The first enemy */
+	unsigned int end;   /**< One past the last enemy */
+	PathFinder * finder; /**< The storage to search for paths with */
+} Chunk;
+
+/**
+ * Add an enemy, due to act, to the batch. Enemies in a batch must all
+ * be in the same level, and none may be the player.
+ * @param mob The enemy
+ */
+void batch_add(Mob * mob) {
+	if(count == capacity) {
+		capacity = (capacity == 0) ? 64 : capacity * 2;
+		batch = xrealloc(batch, capacity, Mob *);
+		rngs = xrealloc(rngs, capacity, Rng);
+		intents = xrealloc(intents, capacity, Intent);
+	}
+
+	batch[count] = mob;
+
+	/* Generators are split off here, in order, so the decisions don't
+	   depend on how the threads are scheduled */
+	rng_split(level_rng(mob->level, RNG_AI), &rngs[count]);
+
+	count ++;
+}
+
+/**
+ * Decide a share of the batch. This only reads the level.
+ * @param arg The chunk
+ */
+static void * decide_chunk(void * arg) {
+	Chunk * chunk = (Chunk *) arg;
+
+	decide_turns(&batch[chunk->start], &rngs[chunk->start],
+	             chunk->end - chunk->start, chunk->finder,
+	             &intents[chunk->start]);
+
+	return NULL;
+}
+
+/**
+ * Run the batch: every enemy decides what to do against the level as
+ * it stands (in parallel, if the batch is large enough), and then the
+ * intents are applied one at a time in the order the enemies were
+ * added. When two enemies decide on the same cell, the first gets it
+ * and the second falls back to its alternative step, or waits.
+ */
+void batch_run(void) {
+	if(count == 0) {
+		return;
+	}
+
+	/* Deciding mustn't write to the level, so any maps the enemies
+	   may want are computed now */
+	prepare_distance_maps(batch[0]->level);
+
+	Chunk chunks[BATCH_THREADS];
+	pthread_t threads[BATCH_THREADS];
+	bool running[BATCH_THREADS] = {false};
+
+	unsigned int nchunks = (count < BATCH_PARALLEL_MIN) ? 1 : BATCH_THREADS;
+	for(unsigned int i = 0; i < nchunks; i++) {
+		chunks[i].start = count * i / nchunks;
+		chunks[i].end = count * (i + 1) / nchunks;
+		chunks[i].finder = &finders[i];
+	}
+
+	/* The main thread takes the first chunk itself, and any chunk a
+	   thread couldn't be had for */
+	for(unsigned int i = 1; i < nchunks; i++) {
+		running[i] = pthread_create(&threads[i], NULL, &decide_chunk, &chunks[i]) == 0;
+	}
+	decide_chunk(&chunks[0]);
+	for(unsigned int i = 1; i < nchunks; i++) {
+		if(running[i]) {
+			pthread_join(threads[i], NULL);
+		} else {
+			decide_chunk(&chunks[i]);
+		}
+	}
+
+	for(unsigned int i = 0; i < count && !quit; i++) {
+		/* Anything killed by those before it in the batch is gone */
+		if(mob_health(batch[i]) <= 0) {
+			continue;
+		}
+
+		apply_intent(batch[i], &intents[i]);
+		finish_action(batch[i]);
+	}
+
+	count = 0;
+}
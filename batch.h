@@ -0,0 +1,15 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "mob.h"
+
+/** Batches smaller than this are decided on the main thread alone. */
+#define BATCH_PARALLEL_MIN 32
+
+/** The number of threads a batch is decided on. */
+#define BATCH_THREADS 4
+
+void batch_add(Mob * mob);
+void batch_run(void);
+
+#endif /* BATCH_H */
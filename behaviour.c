@@ -0,0 +1,421 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "behaviour.h"
+#include "distmap.h"
+#include "scent.h"
+#include "spatial.h"
+#include "area.h"
+#include "utils.h"
+
+/** A node as written, to be compiled. */
+#define NODE(depth, kind, param) {(depth), (kind), (param), 0}
+
+/** The most enemies whose facts are worked out at once. */
+#define DECIDE_BLOCK 64
+
+/**
+ * Simple enemies fight any mob of a hostile faction they see nearer
+ * than the player. Otherwise they wander until they see the player,
+ * then attack them if (orthogonally) next to them or in reach of a
+ * weapon which hits an area, run away if badly hurt, and otherwise
+ * close in.
+ */
+static BehaviourNode simple_tree[] = {
+	NODE(0, BT_SELECTOR, 0),
+	NODE(1,   BT_SEQUENCE, 0),
+	NODE(2,     BT_SEES_FOE, 0),
+	NODE(2,     BT_SELECTOR, 0),
+	NODE(3,       BT_SEQUENCE, 0),
+	NODE(4,         BT_NEXT_TO_FOE, false),
+	NODE(4,         BT_FIGHT, 0),
+	NODE(3,       BT_CLOSE_IN, false),
+	NODE(1,   BT_SEQUENCE, 0),
+	NODE(2,     BT_INVERT, 0),
+	NODE(3,       BT_SEES_PLAYER, 0),
+	NODE(2,     BT_WANDER, false),
+	NODE(1,   BT_SEQUENCE, 0),
+	NODE(2,     BT_IN_BLAST, 0),
+	NODE(2,     BT_ATTACK, 0),
+	NODE(1,   BT_SEQUENCE, 0),
+	NODE(2,     BT_NEXT_TO_PLAYER, false),
+	NODE(2,     BT_ATTACK, 0),
+	NODE(1,   BT_SEQUENCE, 0),
+	NODE(2,     BT_HURT, 0),
+	NODE(2,     BT_FLEE, false),
+	NODE(1,   BT_APPROACH, false)
+};
+
+/**
+ * Hunters attack the player if (diagonally) next to them. Otherwise
+ * they share sightings through their state, fight any mob of a
+ * hostile faction they see nearer than the player, pursue while the
+ * hunt is on, follow the player's trail if there is one, and wander
+ * if not.
+ */
+static BehaviourNode hunter_tree[] = {
+	NODE(0, BT_SELECTOR, 0),
+	NODE(1,   BT_SEQUENCE, 0),
+	NODE(2,     BT_NEXT_TO_PLAYER, true),
+	NODE(2,     BT_ATTACK, 0),
+	NODE(1,   BT_SEQUENCE, 0),
+	NODE(2,     BT_REMEMBER, 0),
+	NODE(2,     BT_SELECTOR, 0),
+	NODE(3,       BT_SEQUENCE, 0),
+	NODE(4,         BT_SEES_FOE, 0),
+	NODE(4,         BT_SELECTOR, 0),
+	NODE(5,           BT_SEQUENCE, 0),
+	NODE(6,             BT_NEXT_TO_FOE, true),
+	NODE(6,             BT_FIGHT, 0),
+	NODE(5,           BT_CLOSE_IN, true),
+	NODE(3,       BT_SEQUENCE, 0),
+	NODE(4,         BT_CHASING, 0),
+	NODE(4,         BT_PURSUE, true),
+	NODE(3,       BT_FOLLOW_SCENT, 0),
+	NODE(3,       BT_WANDER, true)
+};
+
+#undef NODE
+
+/**
+ * A compiled behaviour tree.
+ */
+typedef struct BehaviourTree {
+	BehaviourNode * nodes; /**< The nodes, root first. */
+	unsigned int num_nodes; /**< The number of nodes. */
+} BehaviourTree;
+
+/** The tree for each AI (by enum MobAI), if it has one. */
+static const BehaviourTree trees[] = {
+	[AI_SIMPLE] = {simple_tree, lengthof(simple_tree)},
+	[AI_HUNTER] = {hunter_tree, lengthof(hunter_tree)}
+};
+
+/** Compile the trees just once, whichever thread gets there first. */
+static pthread_once_t compiled = PTHREAD_ONCE_INIT;
+
+/**
+ * What's known about an enemy at the start of its decision. These are
+ * the conditions most trees test, so they're worked out for a block of
+ * enemies at once.
+ */
+typedef struct Facts {
+	int xdiff;        /**< The X distance from the player. */
+	int ydiff;        /**< The Y distance from the player. */
+	bool sees_player; /**< Whether the player is in sight. */
+	Mob * foe;        /**< The nearest hostile mob in sight, if nearer than the player. */
+	int foexdiff;     /**< The X distance from the foe. */
+	int foeydiff;     /**< The Y distance from the foe. */
+} Facts;
+
+/**
+ * Everything a tree can look at and change while an enemy decides.
+ */
+typedef struct Blackboard {
+	Mob * enemy;           /**< The enemy deciding. */
+	Mob * player;          /**< The player. */
+	const Facts * facts;   /**< What's known about the enemy. */
+	Rng * rng;             /**< The decision's generator. */
+	PathFinder * finder;   /**< The storage to search for paths with. */
+	Intent * intent;       /**< The intent being filled in. */
+	bool chase;            /**< Whether the hunt is on (hunters). */
+	unsigned int targetx;  /**< The hunt's target X (hunters). */
+	unsigned int targety;  /**< The hunt's target Y (hunters). */
+} Blackboard;
+
+/**
+ * Work out where the subtree of each node of every tree ends.
+ */
+static void compile_trees(void) {
+	for(unsigned int ai = 0; ai < lengthof(trees); ai++) {
+		BehaviourNode * nodes = trees[ai].nodes;
+
+		for(unsigned int i = 0; i < trees[ai].num_nodes; i++) {
+			unsigned int next = i + 1;
+			while(next < trees[ai].num_nodes && nodes[next].depth > nodes[i].depth) {
+				next ++;
+			}
+			nodes[i].next = next;
+		}
+	}
+}
+
+/**
+ * Run a condition or action.
+ * @param node The node
+ * @param bb The blackboard
+ * @return Whether it succeeded
+ */
+static bool run_leaf(const BehaviourNode * node, Blackboard * bb) {
+	Mob * enemy = bb->enemy;
+	Mob * player = bb->player;
+	Intent * intent = bb->intent;
+	Mob * foe = bb->facts->foe;
+	int xdist = abs(bb->facts->xdiff);
+	int ydist = abs(bb->facts->ydiff);
+	int foexdist = abs(bb->facts->foexdiff);
+	int foeydist = abs(bb->facts->foeydiff);
+	int dx, dy;
+
+	switch((enum BehaviourKind) node->kind) {
+	case BT_SEES_PLAYER:
+		return bb->facts->sees_player;
+	case BT_NEXT_TO_PLAYER:
+		return node->param
+			? (xdist <= 1 && ydist <= 1 && xdist + ydist > 0)
+			: (xdist + ydist == 1);
+	case BT_IN_BLAST:
+		return enemy->weapon != NULL && enemy->weapon->area != AREA_NONE &&
+			bb->facts->sees_player &&
+			area_reaches(enemy, mob_xpos(player), mob_ypos(player));
+	case BT_HURT:
+		return mob_health(enemy) * 4 < (int) mob_stats(enemy)->max_health;
+	case BT_CHASING:
+		return bb->chase;
+	case BT_SEES_FOE:
+		return foe != NULL;
+	case BT_NEXT_TO_FOE:
+		return foe != NULL && (node->param
+			? (foexdist <= 1 && foeydist <= 1)
+			: (foexdist + foeydist == 1));
+
+	case BT_REMEMBER:
+		/* The shared state is updated when the intent is applied */
+		if(bb->facts->sees_player) {
+			intent->sighted = true;
+			intent->seenx = bb->targetx = mob_xpos(player);
+			intent->seeny = bb->targety = mob_ypos(player);
+			bb->chase = true;
+		} else if(bb->chase &&
+		          can_see_point(enemy->level,
+		                        mob_xpos(enemy), mob_ypos(enemy),
+		                        bb->targetx, bb->targety)) {
+			/* The target's in sight, but the player isn't */
+			intent->lost = true;
+			bb->chase = false;
+		}
+		return true;
+	case BT_ATTACK:
+		intent->kind = INTENT_ATTACK;
+		intent->target = player->id;
+		return true;
+	case BT_FLEE:
+		return decide_descend(enemy, DMAP_FLEE, node->param, intent);
+	case BT_APPROACH:
+		/* With no way round, move along the axis furthest away */
+		if(!decide_descend(enemy, DMAP_PLAYER, node->param, intent)) {
+			decide_towards(enemy, mob_xpos(player), mob_ypos(player), node->param, intent);
+		}
+		return true;
+	case BT_PURSUE:
+		/* Down the player's map if the target is where the player
+		   is, along a path to it if not */
+		if((bb->targetx != mob_xpos(player) || bb->targety != mob_ypos(player) ||
+		    !decide_descend(enemy, DMAP_PLAYER, node->param, intent)) &&
+		   !decide_path(enemy, bb->finder, bb->targetx, bb->targety, intent)) {
+			decide_towards(enemy, bb->targetx, bb->targety, node->param, intent);
+		}
+		return true;
+	case BT_FOLLOW_SCENT:
+		if(!scent_step(enemy->level, mob_xpos(enemy), mob_ypos(enemy), &dx, &dy)) {
+			return false;
+		}
+		decide_step(enemy, dx, dy, intent);
+		return true;
+	case BT_FIGHT:
+		if(foe == NULL) {
+			return false;
+		}
+		intent->kind = INTENT_ATTACK;
+		intent->target = foe->id;
+		return true;
+	case BT_CLOSE_IN:
+		if(foe == NULL) {
+			return false;
+		}
+		decide_towards(enemy, mob_xpos(foe), mob_ypos(foe), node->param, intent);
+		return true;
+	case BT_WANDER:
+		if(node->param) {
+			decide_random_diagonals(enemy, bb->rng, intent);
+		} else {
+			decide_random(enemy, bb->rng, intent);
+		}
+		return true;
+	default:
+		assert(false);
+		return false;
+	}
+}
+
+/**
+ * Whether a mob is one an enemy would go and fight, leaving the player
+ * to the trees.
+ * @param mob The mob
+ * @param data The enemy
+ */
+static bool is_foe(Mob * mob, void * data) {
+	Mob * enemy = (Mob *) data;
+
+	return mob != enemy && mob != enemy->level->player &&
+		mob_health(mob) > 0 && hostile_to(enemy, mob) &&
+		can_see_other(enemy, mob);
+}
+
+/**
+ * Find the nearest mob, other than the player, an enemy would go and
+ * fight.
+ * @param enemy The enemy
+ * @param radius How far to look
+ * @return The mob, or NULL if there's none in sight
+ */
+Mob * nearest_foe(Mob * enemy, unsigned int radius) {
+	return nearest_mob(enemy->level, mob_xpos(enemy), mob_ypos(enemy),
+	                   radius, &is_foe, enemy);
+}
+
+/**
+ * Find the nearest hostile mob an enemy can see, if it's nearer than
+ * the player (when the player is in sight).
+ * @param enemy The enemy
+ * @param fact What's known about the enemy so far, to fill in
+ */
+static void find_foe(Mob * enemy, Facts * fact) {
+	unsigned int radius = FOE_RADIUS;
+
+	if(fact->sees_player) {
+		unsigned int xdist = abs(fact->xdiff);
+		unsigned int ydist = abs(fact->ydiff);
+		unsigned int dist = (xdist > ydist) ? xdist : ydist;
+
+		if(dist <= 1) {
+			fact->foe = NULL;
+			fact->foexdiff = 0;
+			fact->foeydiff = 0;
+			return;
+		}
+		radius = (dist - 1 < radius) ? dist - 1 : radius;
+	}
+
+	fact->foe = nearest_foe(enemy, radius);
+	if(fact->foe != NULL) {
+		fact->foexdiff = mob_xpos(enemy) - mob_xpos(fact->foe);
+		fact->foeydiff = mob_ypos(enemy) - mob_ypos(fact->foe);
+	} else {
+		fact->foexdiff = 0;
+		fact->foeydiff = 0;
+	}
+}
+
+/**
+ * Run a node and, for composites, its children.
+ * @param tree The tree
+ * @param index The node
+ * @param bb The blackboard
+ * @return Whether it succeeded
+ */
+static bool run_node(const BehaviourTree * tree, unsigned int index, Blackboard * bb) {
+	const BehaviourNode * node = &tree->nodes[index];
+
+	switch(node->kind) {
+	case BT_SELECTOR:
+		for(unsigned int child = index + 1; child < node->next; child = tree->nodes[child].next) {
+			if(run_node(tree, child, bb)) {
+				return true;
+			}
+		}
+		return false;
+	case BT_SEQUENCE:
+		for(unsigned int child = index + 1; child < node->next; child = tree->nodes[child].next) {
+			if(!run_node(tree, child, bb)) {
+				return false;
+			}
+		}
+		return true;
+	case BT_INVERT:
+		return !run_node(tree, index + 1, bb);
+	default:
+		return run_leaf(node, bb);
+	}
+}
+
+/**
+ * Decide what a number of enemies will do with their turns, without
+ * changing anything. The conditions most trees test are worked out
+ * for a block of enemies first, then each tree is run over the
+ * enemies which use it. Enemies in the same level can decide at the
+ * same time, once prepare_distance_maps has been called.
+ * @param enemies The enemies, all in the same level
+ * @param rngs A generator for each decision, which no other decision
+ * may be using at the same time
+ * @param count The number of enemies
+ * @param finder The storage to search for paths with, which no other
+ * decision may be using at the same time
+ * @param intents The intents to fill in
+ */
+void decide_turns(Mob ** enemies, Rng * rngs,
+                  unsigned int count, PathFinder * finder,
+                  Intent * intents) {
+	Facts facts[DECIDE_BLOCK];
+
+	pthread_once(&compiled, &compile_trees);
+
+	for(unsigned int start = 0; start < count; start += DECIDE_BLOCK) {
+		unsigned int end = (start + DECIDE_BLOCK < count) ? start + DECIDE_BLOCK : count;
+		Mob * player = enemies[start]->level->player;
+
+		for(unsigned int i = start; i < end; i++) {
+			Facts * fact = &facts[i - start];
+
+			intents[i] = (Intent) {.kind = INTENT_WAIT, .target = NO_MOB};
+			fact->xdiff = mob_xpos(enemies[i]) - mob_xpos(player);
+			fact->ydiff = mob_ypos(enemies[i]) - mob_ypos(player);
+			fact->sees_player = can_see_other(enemies[i], player);
+			find_foe(enemies[i], fact);
+		}
+
+		for(unsigned int ai = 0; ai < lengthof(trees); ai++) {
+			if(trees[ai].nodes == NULL) {
+				continue;
+			}
+
+			for(unsigned int i = start; i < end; i++) {
+				if(mob_ai(enemies[i]) != (enum MobAI) ai) {
+					continue;
+				}
+
+				Blackboard bb = {
+					.enemy = enemies[i],
+					.player = player,
+					.facts = &facts[i - start],
+					.rng = &rngs[i],
+					.finder = finder,
+					.intent = &intents[i]
+				};
+
+				const HunterState * data = (const HunterState *) enemies[i]->data;
+				if(ai == AI_HUNTER) {
+					assert(data != NULL);
+					bb.chase = data->chase;
+					bb.targetx = data->x;
+					bb.targety = data->y;
+				}
+
+				run_node(&trees[ai], 0, &bb);
+			}
+		}
+	}
+}
+
+/**
+ * Decide what an enemy will do with its turn, without changing
+ * anything.
+ * @param enemy The enemy
+ * @param rng The generator to decide with
+ * @param finder The storage to search for paths with
+ * @param intent The intent to fill in
+ */
+void decide_turn(Mob * enemy, Rng * rng, PathFinder * finder, Intent * intent) {
+	decide_turns(&enemy, rng, 1, finder, intent);
+}
@@ -0,0 +1,62 @@
+#ifndef BEHAVIOUR_H
+#define BEHAVIOUR_H
+
+#include <stdbool.h>
+
+#include "mob.h"
+#include "enemy.h"
+#include "astar.h"
+
+/** How far away an enemy notices other mobs to fight. */
+#define FOE_RADIUS 8
+
+/**
+ * The kinds of node in a behaviour tree. Composites run their
+ * children in order; conditions check something and change nothing;
+ * actions decide on something, failing if they can't.
+ */
+enum BehaviourKind {
+	BT_SELECTOR,      /**< Succeeds with the first child which does. */
+	BT_SEQUENCE,      /**< Fails with the first child which does. */
+	BT_INVERT,        /**< Its one child, with the result reversed. */
+
+	BT_SEES_PLAYER,   /**< Whether the player is in sight. */
+	BT_NEXT_TO_PLAYER, /**< Whether next to the player (param: diagonally too). */
+	BT_IN_BLAST,      /**< Whether the player is in reach of an area weapon. */
+	BT_HURT,          /**< Whether badly hurt. */
+	BT_CHASING,       /**< Whether the hunt is on. */
+	BT_SEES_FOE,      /**< Whether a hostile mob other than the player is in sight, and nearer. */
+	BT_NEXT_TO_FOE,   /**< Whether next to that mob (param: diagonally too). */
+
+	BT_REMEMBER,      /**< Note a sighting, or that the trail has gone cold. */
+	BT_ATTACK,        /**< Attack the player. */
+	BT_FLEE,          /**< Step away from the player (param: diagonally). */
+	BT_APPROACH,      /**< Step towards the player (param: diagonally). */
+	BT_PURSUE,        /**< Step towards the hunt's target. */
+	BT_FOLLOW_SCENT,  /**< Step up the player's trail. */
+	BT_FIGHT,         /**< Attack the hostile mob in sight. */
+	BT_CLOSE_IN,      /**< Step towards the hostile mob in sight (param: diagonally). */
+	BT_WANDER         /**< Step at random (param: diagonally). */
+};
+
+/**
+ * A node of a behaviour tree. Trees are written as lists of nodes in
+ * the order they'd be visited, each with its depth, and compiled by
+ * working out where each node's subtree ends: a node's children are
+ * then found by skipping from one to the next, and a whole tree is one
+ * flat array.
+ */
+typedef struct BehaviourNode {
+	unsigned char depth;  /**< The depth in the tree, as written. */
+	unsigned char kind;   /**< The enum BehaviourKind. */
+	unsigned char param;  /**< What a leaf needs to know, if anything. */
+	unsigned short next;  /**< The node after its subtree, once compiled. */
+} BehaviourNode;
+
+Mob * nearest_foe(Mob * enemy, unsigned int radius);
+void decide_turn(Mob * enemy, Rng * rng, PathFinder * finder, Intent * intent);
+void decide_turns(Mob ** enemies, Rng * rngs,
+                  unsigned int count, PathFinder * finder,
+                  Intent * intents);
+
+#endif /* BEHAVIOUR_H */
@@ -0,0 +1,113 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "level.h"
+#include "mob.h"
+#include "astar.h"
+#include "rng.h"
+#include "utils.h"
+
+/** The number of levels generated. */
+#define BENCH_LEVELS 8
+
+/** The number of searches run on each level, for each set of options. */
+#define BENCH_QUERIES 5000
+
+/* What the game's main.c would otherwise define */
+bool quit = false;
+bool parallel_ai = false;
+bool realtime = false;
+bool background_levels = false;
+unsigned long ai_budget = 0;
+unsigned long ai_overruns = 0;
+unsigned long game_seed = 1;
+
+/**
+ * The time on a monotonic clock, in nanoseconds.
+ */
+static long long now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Pick a random open cell of a level.
+ * @param level The level
+ * @param rng The generator to draw from
+ * @param x Set to the X of the cell
+ * @param y Set to the Y of the cell
+ */
+static void random_open_cell(Level * level, Rng * rng, unsigned int * x, unsigned int * y) {
+	do {
+		*x = rng_below(rng, LEVELWIDTH);
+		*y = rng_below(rng, LEVELHEIGHT);
+	} while(level->cells[*x][*y]->solid);
+}
+
+/**
+ * Time find_path between random open cells of generated levels, for
+ * walking and for digging, and print the mean time per search.
+ * Usage: bench_astar [SEED]
+ */
+int main(int argc, char ** argv) {
+	if(argc > 1) {
+		game_seed = strtoul(argv[1], NULL, 10);
+	}
+
+	static PathFinder finder;
+	PathStep steps[LEVELWIDTH + LEVELHEIGHT];
+
+	const PathOptions options[] = {
+		{.diagonal = false},
+		{.diagonal = true},
+		{.diagonal = true, .cost = path_dig_cost, .min_cost = 1}
+	};
+	const char * names[] = {"walk, orthogonal", "walk, diagonal", "dig, diagonal"};
+
+	long long elapsed[lengthof(options)] = {0};
+	unsigned long found[lengthof(options)] = {0};
+
+	for(unsigned int depth = 0; depth < BENCH_LEVELS; depth++) {
+		Level * level = xalloc(Level);
+		level->depth = depth;
+
+		/* The level is built around the player */
+		Mob * player = xalloc(Mob);
+		register_mob(level, player);
+		level->player = player;
+		build_level(level);
+
+		Rng rng;
+		rng_stream(&rng, RNG_AUTOPLAY, depth);
+
+		for(unsigned int i = 0; i < lengthof(options); i++) {
+			unsigned int from[BENCH_QUERIES][2], to[BENCH_QUERIES][2];
+			for(unsigned int q = 0; q < BENCH_QUERIES; q++) {
+				random_open_cell(level, &rng, &from[q][0], &from[q][1]);
+				random_open_cell(level, &rng, &to[q][0], &to[q][1]);
+			}
+
+			long long start = now();
+			for(unsigned int q = 0; q < BENCH_QUERIES; q++) {
+				if(find_path(&finder, level, from[q][0], from[q][1], to[q][0], to[q][1],
+				             &options[i], steps, lengthof(steps)) != PATH_NONE) {
+					found[i] ++;
+				}
+			}
+			elapsed[i] += now() - start;
+		}
+	}
+
+	for(unsigned int i = 0; i < lengthof(options); i++) {
+		printf("%-18s %8.2f us/search (%lu of %u found)\n", names[i],
+		       elapsed[i] / 1000.0 / (BENCH_LEVELS * BENCH_QUERIES),
+		       found[i], BENCH_LEVELS * BENCH_QUERIES);
+	}
+
+	return 0;
+}
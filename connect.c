@@ -0,0 +1,173 @@
+#include "connect.h"
+#include "utils.h"
+
+/** The neighbours of a cell. */
+static const int neighbours[8][2] = {
+	{0, -1}, {0, 1}, {-1, 0}, {1, 0},
+	{-1, -1}, {1, -1}, {-1, 1}, {1, 1}
+};
+
+/**
+ * The label another has been merged into. Merging by size keeps the
+ * chains short, so nothing is written and lookups can be made from
+ * several threads at once.
+ * @param conn The connectivity
+ * @param label The label
+ */
+static unsigned short find_label(const Connectivity * conn, unsigned short label) {
+	while(conn->parent[label] != label) {
+		label = conn->parent[label];
+	}
+
+	return label;
+}
+
+/**
+ * Merge two labels.
+ * @param conn The connectivity
+ * @param a One label
+ * @param b The other
+ * @return The merged label
+ */
+static unsigned short merge_labels(Connectivity * conn, unsigned short a, unsigned short b) {
+	a = find_label(conn, a);
+	b = find_label(conn, b);
+
+	if(a == b) {
+		return a;
+	}
+
+	if(conn->size[a] < conn->size[b]) {
+		unsigned short swap = a;
+		a = b;
+		b = swap;
+	}
+
+	conn->parent[b] = a;
+	conn->size[a] += conn->size[b];
+	return a;
+}
+
+/**
+ * Label the connected parts of a level, by flood filling from each
+ * open cell not yet labelled.
+ * @param level The level
+ */
+void label_level(Level * level) {
+	if(level->connectivity == NULL) {
+		level->connectivity = xalloc(Connectivity);
+	}
+
+	Connectivity * conn = level->connectivity;
+	unsigned int stack[LEVELWIDTH * LEVELHEIGHT];
+
+	conn->num_labels = 0;
+	for(unsigned int x = 0; x < LEVELWIDTH; x++) {
+		for(unsigned int y = 0; y < LEVELHEIGHT; y++) {
+			conn->label[x][y] = NO_LABEL;
+		}
+	}
+
+	for(unsigned int x = 0; x < LEVELWIDTH; x++) {
+		for(unsigned int y = 0; y < LEVELHEIGHT; y++) {
+			if(level->cells[x][y]->solid || conn->label[x][y] != NO_LABEL) {
+				continue;
+			}
+
+			unsigned short label = conn->num_labels ++;
+			unsigned int top = 0;
+
+			conn->parent[label] = label;
+			conn->size[label] = 1;
+			conn->label[x][y] = label;
+			stack[top++] = x * LEVELHEIGHT + y;
+
+			while(top > 0) {
+				unsigned int cx = stack[--top] / LEVELHEIGHT;
+				unsigned int cy = stack[top] % LEVELHEIGHT;
+
+				for(unsigned int i = 0; i < 8; i++) {
+					int nx = cx + neighbours[i][0];
+					int ny = cy + neighbours[i][1];
+
+					if(nx >= 0 && ny >= 0 && nx < LEVELWIDTH && ny < LEVELHEIGHT &&
+					   !level->cells[nx][ny]->solid && conn->label[nx][ny] == NO_LABEL) {
+						conn->label[nx][ny] = label;
+						stack[top++] = nx * LEVELHEIGHT + ny;
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Update the labels after a cell has been dug out: it joins whatever
+ * parts it touches, or becomes a part of its own.
+ * @param level The level
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ */
+void connect_dug(Level * level, unsigned int x, unsigned int y) {
+	Connectivity * conn = level->connectivity;
+
+	if(conn == NULL || conn->label[x][y] != NO_LABEL) {
+		return;
+	}
+
+	unsigned short label = NO_LABEL;
+
+	for(unsigned int i = 0; i < 8; i++) {
+		int nx = x + neighbours[i][0];
+		int ny = y + neighbours[i][1];
+
+		if(nx < 0 || ny < 0 || nx >= LEVELWIDTH || ny >= LEVELHEIGHT ||
+		   conn->label[nx][ny] == NO_LABEL) {
+			continue;
+		}
+
+		label = (label == NO_LABEL) ?
+			find_label(conn, conn->label[nx][ny]) :
+			merge_labels(conn, label, conn->label[nx][ny]);
+	}
+
+	if(label == NO_LABEL) {
+		label = conn->num_labels ++;
+		conn->parent[label] = label;
+		conn->size[label] = 1;
+	}
+
+	conn->label[x][y] = label;
+}
+
+/**
+ * Whether one cell can be walked to from another.
+ * @param level The level
+ * @param fromx The X to start from
+ * @param fromy The Y to start from
+ * @param tox The X to get to
+ * @param toy The Y to get to
+ */
+bool reachable(const Level * level,
+               unsigned int fromx, unsigned int fromy,
+               unsigned int tox, unsigned int toy) {
+	const Connectivity * conn = level->connectivity;
+
+	if(conn == NULL) {
+		return true;
+	}
+
+	unsigned short from = conn->label[fromx][fromy];
+	unsigned short to = conn->label[tox][toy];
+
+	return from != NO_LABEL && to != NO_LABEL &&
+		find_label(conn, from) == find_label(conn, to);
+}
+
+/**
+ * Free the labels of a level.
+ * @param level The level
+ */
+void free_connectivity(Level * level) {
+	xfree(level->connectivity);
+}
@@ -0,0 +1,32 @@
+#ifndef CONNECT_H
+#define CONNECT_H
+
+#include <stdbool.h>
+
+#include "level.h"
+
+/** The label of a solid cell. */
+#define NO_LABEL 0xFFFF
+
+/**
+ * The connected parts of a level: every open cell is labelled, so that
+ * cells with the same label can reach each other (diagonal steps
+ * included). Digging only ever joins parts, so labels joined since
+ * the level was labelled are merged with a union-find over the labels
+ * rather than by relabelling cells.
+ */
+typedef struct Connectivity {
+	unsigned short label[LEVELWIDTH][LEVELHEIGHT]; /**< The label of each cell. */
+	unsigned short parent[LEVELWIDTH * LEVELHEIGHT]; /**< The label each has been merged into. */
+	unsigned short size[LEVELWIDTH * LEVELHEIGHT];   /**< The number of labels merged into each. */
+	unsigned int num_labels; /**< The number of labels given out. */
+} Connectivity;
+
+void label_level(Level * level);
+void connect_dug(Level * level, unsigned int x, unsigned int y);
+bool reachable(const Level * level,
+               unsigned int fromx, unsigned int fromy,
+               unsigned int tox, unsigned int toy);
+void free_connectivity(Level * level);
+
+#endif /* CONNECT_H */
@@ -0,0 +1,271 @@
+#include <limits.h>
+#include <stddef.h>
+
+#include "distmap.h"
+#include "mob.h"
+#include "utils.h"
+
+/** The distance of one step. Steps are worth more than one so that
+ * flee maps can scale distances without losing precision. */
+#define STEP 10
+
+/** How much fleeing mobs value distance from the player over distance
+ * to travel: a flee map starts each cell at minus this many times
+ * its distance from the player, in tenths. */
+#define FLEE_SCALE 12
+
+/** The neighbours of a cell, orthogonal ones first. */
+static const int neighbours[8][2] = {
+	{0, -1}, {0, 1}, {-1, 0}, {1, 0},
+	{-1, -1}, {1, -1}, {-1, 1}, {1, 1}
+};
+
+/**
+ * Check if a cell is inside the level, and can be walked through.
+ * @param level The level
+ * @param x The X
+ * @param y The Y
+ */
+static bool passable(Level * level, int x, int y) {
+	return x >= 0 && y >= 0 && x < LEVELWIDTH && y < LEVELHEIGHT &&
+		!level->cells[x][y]->solid;
+}
+
+/**
+ * Fill in a map with the distance of every cell from a goal,
+ * breadth-first.
+ * @param level The level
+ * @param map The map
+ * @param goalx The X of the goal
+ * @param goaly The Y of the goal
+ * @param diagonal Whether diagonal steps are allowed
+ */
+static void flood(Level * level, DistanceMap * map,
+                  unsigned int goalx, unsigned int goaly,
+                  bool diagonal) {
+	unsigned int queue[LEVELWIDTH * LEVELHEIGHT];
+	unsigned int head = 0, tail = 0;
+	unsigned int num_neighbours = diagonal ? 8 : 4;
+
+	for(unsigned int x = 0; x < LEVELWIDTH; x++) {
+		for(unsigned int y = 0; y < LEVELHEIGHT; y++) {
+			map->dist[x][y] = DIST_UNREACHABLE;
+		}
+	}
+
+	map->dist[goalx][goaly] = 0;
+	queue[tail++] = goalx * LEVELHEIGHT + goaly;
+
+	while(head < tail) {
+		unsigned int x = queue[head] / LEVELHEIGHT;
+		unsigned int y = queue[head] % LEVELHEIGHT;
+		head ++;
+
+		for(unsigned int i = 0; i < num_neighbours; i++) {
+			int nx = x + neighbours[i][0];
+			int ny = y + neighbours[i][1];
+
+			if(passable(level, nx, ny) && map->dist[nx][ny] == DIST_UNREACHABLE) {
+				map->dist[nx][ny] = map->dist[x][y] + STEP;
+				queue[tail++] = nx * LEVELHEIGHT + ny;
+			}
+		}
+	}
+}
+
+/**
+ * Fill in a flee map from a map to the player: every cell starts at
+ * a negative multiple of its distance from the player, and is then
+ * lowered to one step more than its lowest neighbour (Dijkstra from
+ * every cell at once). Descending the result leads away from the
+ * player, but not into a dead end close by.
+ * @param level The level
+ * @param map The map to fill in
+ * @param player The map to the player
+ * @param diagonal Whether diagonal steps are allowed
+ */
+static void flee(Level * level, DistanceMap * map, const DistanceMap * player,
+                 bool diagonal) {
+	Heap * open = &level->distmaps->open;
+	unsigned int num_neighbours = diagonal ? 8 : 4;
+
+	/* Heap keys are unsigned, so are offset by the lowest distance */
+	int lowest = 0;
+	for(unsigned int x = 0; x < LEVELWIDTH; x++) {
+		for(unsigned int y = 0; y < LEVELHEIGHT; y++) {
+			if(player->dist[x][y] == DIST_UNREACHABLE) {
+				map->dist[x][y] = DIST_UNREACHABLE;
+			} else {
+				map->dist[x][y] = -player->dist[x][y] * FLEE_SCALE / STEP;
+				if(map->dist[x][y] < lowest) {
+					lowest = map->dist[x][y];
+				}
+			}
+		}
+	}
+
+	for(unsigned int x = 0; x < LEVELWIDTH; x++) {
+		for(unsigned int y = 0; y < LEVELHEIGHT; y++) {
+			if(map->dist[x][y] != DIST_UNREACHABLE) {
+				heap_push(open, map->dist[x][y] - lowest, x * LEVELHEIGHT + y);
+			}
+		}
+	}
+
+	HeapEntry entry;
+	while(heap_pop(open, &entry)) {
+		unsigned int x = entry.value / LEVELHEIGHT;
+		unsigned int y = entry.value % LEVELHEIGHT;
+		int dist = (int) entry.key + lowest;
+
+		/* Already settled lower */
+		if(dist > map->dist[x][y]) {
+			continue;
+		}
+
+		for(unsigned int i = 0; i < num_neighbours; i++) {
+			int nx = x + neighbours[i][0];
+			int ny = y + neighbours[i][1];
+
+			if(passable(level, nx, ny) && dist + STEP < map->dist[nx][ny]) {
+				map->dist[nx][ny] = dist + STEP;
+				heap_push(open, dist + STEP - lowest, nx * LEVELHEIGHT + ny);
+			}
+		}
+	}
+}
+
+/**
+ * Get a distance map of a level, computing it if the terrain or the
+ * goal has changed since it last was. This is only safe on the thread
+ * running the level; other threads should only use maps which have
+ * already been brought up to date with prepare_distance_maps.
+ * @param level The level
+ * @param goal What the map leads to
+ * @param diagonal Whether the map allows diagonal steps
+ * @return The map, or NULL if the goal is the player and they aren't
+ *         in the level.
+ */
+const DistanceMap * distance_map(Level * level, enum DistanceGoal goal, bool diagonal) {
+	unsigned int goalx, goaly;
+
+	switch(goal) {
+	case DMAP_PLAYER:
+	case DMAP_FLEE:
+		if(level->player == NULL) {
+			return NULL;
+		}
+		goalx = mob_xpos(level->player);
+		goaly = mob_ypos(level->player);
+		break;
+	case DMAP_STAIRS_DOWN:
+		goalx = level->endx;
+		goaly = level->endy;
+		break;
+	case DMAP_STAIRS_UP:
+	default:
+		goalx = level->startx;
+		goaly = level->starty;
+		break;
+	}
+
+	if(level->distmaps == NULL) {
+		level->distmaps = xalloc(DistanceMaps);
+	}
+
+	DistanceMap * map = &level->distmaps->maps[goal][diagonal];
+	if(map->valid && map->epoch == level->terrain_epoch &&
+	   map->goalx == goalx && map->goaly == goaly) {
+		return map;
+	}
+
+	if(goal == DMAP_FLEE) {
+		flee(level, map, distance_map(level, DMAP_PLAYER, diagonal), diagonal);
+	} else {
+		flood(level, map, goalx, goaly, diagonal);
+	}
+
+	map->valid = true;
+	map->epoch = level->terrain_epoch;
+	map->goalx = goalx;
+	map->goaly = goaly;
+
+	return map;
+}
+
+/**
+ * Bring the maps enemies use up to date, so that they can then be
+ * read from several threads at once.
+ * @param level The level
+ */
+void prepare_distance_maps(Level * level) {
+	if(level->player == NULL) {
+		return;
+	}
+
+	distance_map(level, DMAP_PLAYER, false);
+	distance_map(level, DMAP_PLAYER, true);
+	distance_map(level, DMAP_FLEE, false);
+}
+
+/**
+ * Find the best step down a distance map from a cell, and the next
+ * best to fall back on if that is blocked. Mobs aren't taken into
+ * account.
+ * @param map The map
+ * @param level The level
+ * @param x The X to step from
+ * @param y The Y to step from
+ * @param diagonal Whether to consider diagonal steps
+ * @param dx Set to the X of the best step
+ * @param dy Set to the Y of the best step
+ * @param altdx Set to the X of the next best (0 if none)
+ * @param altdy Set to the Y of the next best (0 if none)
+ * @return false if no neighbour is any closer to the goal
+ */
+bool distance_map_step(const DistanceMap * map, Level * level,
+                       unsigned int x, unsigned int y,
+                       bool diagonal,
+                       int * dx, int * dy, int * altdx, int * altdy) {
+	unsigned int num_neighbours = diagonal ? 8 : 4;
+	int best = map->dist[x][y];
+	int second = map->dist[x][y];
+
+	*dx = *dy = *altdx = *altdy = 0;
+
+	for(unsigned int i = 0; i < num_neighbours; i++) {
+		int nx = x + neighbours[i][0];
+		int ny = y + neighbours[i][1];
+
+		if(!passable(level, nx, ny)) {
+			continue;
+		}
+
+		int dist = map->dist[nx][ny];
+		if(dist < best) {
+			second = best;
+			*altdx = *dx;
+			*altdy = *dy;
+			best = dist;
+			*dx = neighbours[i][0];
+			*dy = neighbours[i][1];
+		} else if(dist < second) {
+			second = dist;
+			*altdx = neighbours[i][0];
+			*altdy = neighbours[i][1];
+		}
+	}
+
+	return best < map->dist[x][y];
+}
+
+/**
+ * Free the distance maps of a level.
+ * @param level The level
+ */
+void free_distance_maps(Level * level) {
+	if(level->distmaps != NULL) {
+		heap_free(&level->distmaps->open);
+		xfree(level->distmaps);
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef DISTMAP_H
+#define DISTMAP_H
+
+#include <stdbool.h>
+#include <limits.h>
+
+#include "level.h"
+#include "heap.h"
+
+/** The distance of a cell from which the goal can't be reached. */
+#define DIST_UNREACHABLE INT_MAX
+
+/**
+ * The things a distance map can lead to. DMAP_FLEE leads away from
+ * the player, preferring open space to corners.
+ */
+enum DistanceGoal { DMAP_PLAYER, DMAP_STAIRS_DOWN, DMAP_STAIRS_UP, DMAP_FLEE, NUM_DMAP_GOALS };
+
+/**
+ * A distance map: for every cell, how far it is from the nearest goal
+ * (walls and rock are unreachable, mobs are ignored), so that a mob
+ * can find its way by stepping to a neighbour with a lower distance.
+ * Only the order of the distances matters; they are not necessarily
+ * in steps.
+ */
+typedef struct DistanceMap {
+	bool valid;          /**< Whether the map has been computed. */
+	unsigned long epoch; /**< The terrain epoch it was computed at. */
+	unsigned int goalx;  /**< The X of the goal it was computed for. */
+	unsigned int goaly;  /**< The Y of the goal it was computed for. */
+	int dist[LEVELWIDTH][LEVELHEIGHT]; /**< The distance of each cell. */
+} DistanceMap;
+
+/**
+ * The distance maps of a level, for each goal, with and without
+ * diagonal moves.
+ */
+typedef struct DistanceMaps {
+	DistanceMap maps[NUM_DMAP_GOALS][2]; /**< The maps, by goal and diagonality. */
+	Heap open; /**< The cells still to be settled, while computing a flee map. */
+} DistanceMaps;
+
+const DistanceMap * distance_map(Level * level, enum DistanceGoal goal, bool diagonal);
+void prepare_distance_maps(Level * level);
+bool distance_map_step(const DistanceMap * map, Level * level,
+                       unsigned int x, unsigned int y,
+                       bool diagonal,
+                       int * dx, int * dy, int * altdx, int * altdy);
+void free_distance_maps(Level * level);
+
+#endif /* DISTMAP_H */
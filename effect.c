@@ -6,6 +6,8 @@
 #include "mob.h"
 #include "effect.h"
 #include "status.h"
+#include "utils.h"
+#include "hazard.h"
 
 /**
  * Check if a mob is suffering from an effect or not
@@ -13,18 +15,137 @@
  * @return true if effected by something.
  */
 bool is_afflicted(Mob * mob) {
-	return (mob->effect_action != NULL);
+	return (mob_effects(mob)->first != NULL);
 }
 
 /**
- * Apply an effect to a mob (this removes any prior effect)
+ * Find a mob's effect of a kind.
+ * @param mob Entity to examine.
+ * @param effect The kind of effect.
+ * @return The effect, or NULL if the mob isn't suffering from it.
+ */
+static Effect * find_effect(Mob * mob, void (*effect)(Mob *)) {
+	list_foreach(Effect, effects, tmp, mob_effects(mob)) {
+		if(tmp->action == effect) {
+			return tmp;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Check if a mob is suffering from a particular effect.
+ * @param mob Entity to examine.
+ * @param effect The kind of effect.
+ */
+bool has_effect(Mob * mob, void (*effect)(Mob *)) {
+	return find_effect(mob, effect) != NULL;
+}
+
+/**
+ * Take an effect off its mob, and free it.
+ * @param effect The effect.
+ */
+static void remove_effect(Effect * effect) {
+	list_drop(mob_effects(effect->mob), &effect->effects);
+	list_drop(&effect->mob->level->effects, &effect->active);
+	wheel_remove(&effect->expiry);
+	xfree(effect);
+}
+
+/**
+ * Set when an effect wears off.
+ * @param effect The effect, which is in no wheel.
+ * @param duration Number of turns to run the effect for (<0 = infinite)
+ */
+static void set_expiry(Effect * effect, int duration) {
+	if(duration >= 0) {
+		TimerWheel * wheel = &effect->mob->level->expiries;
+		wheel_add(wheel, &effect->expiry, wheel->now + (unsigned long) duration + 1);
+	}
+}
+
+/**
+ * Apply an effect to a mob, alongside any others. If the mob already
+ * suffers from this effect, it starts over with the new duration.
  * @param mob Entity to afflict.
  * @param effect Effect to apply.
- * @param duration Number of turns to apply the effect for (<1 = infinite)
+ * @param duration Number of turns to apply the effect for (<0 = infinite)
  */
 void afflict(Mob * mob, void (*effect)(Mob *), int duration) {
-	mob->effect_action = effect;
-	mob->effect_duration = duration;
+	Effect * existing = find_effect(mob, effect);
+	if(existing != NULL) {
+		wheel_remove(&existing->expiry);
+		set_expiry(existing, duration);
+		return;
+	}
+
+	Effect * new = xalloc(Effect);
+	new->mob = mob;
+	new->action = effect;
+
+	list_push(mob_effects(mob), &new->effects);
+	list_push(&mob->level->effects, &new->active);
+	set_expiry(new, duration);
+}
+
+/**
+ * Move the level's effect clock on a turn, taking off the effects
+ * which wear off then, and run the rest. An effect runs once a turn
+ * for its duration, then wears off at the next.
+ * @param level The level.
+ */
+void run_effects(Level * level) {
+	wheel_advance(&level->expiries);
+
+	Timer * timer;
+	while((timer = wheel_pop(&level->expiries)) != NULL) {
+		Effect * effect = fromlist(Effect, expiry, timer);
+
+		if(effect->mob == level->player) {
+			status_push("The effect wears off.");
+		}
+		remove_effect(effect);
+	}
+
+	list_foreach_safe(Effect, active, effect, next, &level->effects) {
+		/* Effects on the dead wait to be cleared away with them */
+		if(mob_health(effect->mob) > 0) {
+			effect->action(effect->mob);
+		}
+	}
+}
+
+/**
+ * Move a mob's effects from one level to another, keeping the time
+ * until each wears off.
+ * @param mob The mob.
+ * @param from The level the mob is leaving.
+ * @param to The level the mob is entering.
+ */
+void move_effects(Mob * mob, Level * from, Level * to) {
+	list_foreach(Effect, effects, effect, mob_effects(mob)) {
+		list_drop(&from->effects, &effect->active);
+		list_push(&to->effects, &effect->active);
+
+		if(effect->expiry.head != NULL) {
+			unsigned long wait = effect->expiry.due - from->expiries.now;
+
+			wheel_remove(&effect->expiry);
+			wheel_add(&to->expiries, &effect->expiry, to->expiries.now + wait);
+		}
+	}
+}
+
+/**
+ * Remove all of a mob's effects.
+ * @param mob The mob.
+ */
+void clear_effects(Mob * mob) {
+	list_foreach_safe(Effect, effects, effect, next, mob_effects(mob)) {
+		remove_effect(effect);
+	}
 }
 
 /**
@@ -43,12 +164,13 @@ void effect_poison(Mob * mob) {
  * @param mob The mob which is poisoned
  */
 void cure_poison(Mob * mob) {
-	if(mob->effect_action == &effect_poison) {
+	Effect * poison = find_effect(mob, &effect_poison);
+
+	if(poison != NULL) {
 		if(mob == mob->level->player) {
 			status_push("You have been cured of poison.");
 		}
-		mob->effect_action = NULL;
-		mob->effect_duration = 0;
+		remove_effect(poison);
 	}
 }
 
@@ -68,14 +190,14 @@ void effect_burn(Mob * mob) {
  * @param mob The mob which is affected
  */
 void corpse_effect(Mob * mob){
-	if (rand() % 2) {
+	if (rng_below(level_rng(mob->level, RNG_COMBAT), 2)) {
 		if(mob == mob->level->player) {
 			status_push("The corpse was rotten! You are poisoned!");
 		}
 
 		int duration = 7;
-		if(mob->con != 0) {
-			duration -= rand() % mob->con;
+		if(mob_stats(mob)->con != 0) {
+			duration -= (int) rng_below(level_rng(mob->level, RNG_COMBAT), mob_stats(mob)->con);
 		}
 		duration = (duration < 2) ? 2 : duration;
 		afflict(mob, effect_poison, duration);
@@ -109,7 +231,7 @@ void reflect_damage(Mob * owner, Item * self,
 		status_push("Your %s reflected %d of the damage back!",
 		            self->name,
 		            reflected);
-	} else {
+	} else if(attacker == attacker->level->player) {
 		status_push("You got hit with %d reflected damage!",
 		            reflected);
 	}
@@ -129,9 +251,8 @@ void inflict_fire(Mob * owner, Item * self,
 	(void) self;
 	(void) damage;
 
-	if(owner == attacker) {
-		afflict(defender, effect_burn, 3);
-	} else {
-		afflict(attacker, effect_burn, 3);
-	}
+	/* The fire catches where the victim stands */
+	Mob * victim = (owner == attacker) ? defender : attacker;
+	afflict(victim, effect_burn, 3);
+	ignite(victim->level, mob_xpos(victim), mob_ypos(victim));
 }
@@ -2,9 +2,30 @@
 #define EFFECT_H
 
 #include "mob.h"
+#include "level.h"
+#include "timerwheel.h"
+
+/**
+ * An effect on a mob, which does something to it every turn until it
+ * wears off. A mob can suffer from several at once, but only one of
+ * each kind. Every effect in a level is kept in a list, so mobs without
+ * any cost nothing, and its wearing off waits in the level's timer
+ * wheel rather than being counted down.
+ */
+typedef struct Effect {
+	List effects;     /**< The other effects on the mob. */
+	List active;      /**< The other effects in the level. */
+	Timer expiry;     /**< When the effect wears off (in no wheel if it never does). */
+	struct Mob * mob; /**< The afflicted mob. */
+	void (*action)(struct Mob *); /**< What to do every turn. */
+} Effect;
 
 bool is_afflicted(Mob * mob);
+bool has_effect(Mob * mob, void (*effect)(Mob *));
 void afflict(Mob * mob, void (*effect)(Mob *), int duration);
+void run_effects(Level * level);
+void move_effects(Mob * mob, Level * from, Level * to);
+void clear_effects(Mob * mob);
 void effect_poison(Mob * mob);
 void effect_burn(Mob * mob);
 void cure_poison(Mob * mob);
@@ -3,84 +3,92 @@
 #include <stddef.h>
 #include <string.h>
 #include <curses.h>
+#include <math.h>
 #include "enemy.h"
 #include "mob.h"
 #include "effect.h"
+#include "distmap.h"
+#include "regions.h"
+#include "behaviour.h"
+#include "area.h"
+#include "schedule.h"
+#include "connect.h"
+#include "scent.h"
 
 /**
  * Definitions of enemies
  */
-#define ENEMY(sym, n, col, hlth, atk, def, cn, dep) {	  \
-		.symbol = (sym), .colour = (col), .name = (n), .is_bold = false,\
-		.hostile = true,\
-		.health = (hlth), .max_health = (hlth),\
-		.attack = (atk), .defense = (def), .con = (cn),\
-		.level = NULL, .xpos = 0, .ypos = 0,\
-        .moblist = {.next = NULL, .prev=NULL},\
-        .turn_action = NULL,\
-		.score = 0,\
-	    .darksight = true, .luminosity = 0,\
-	    .min_depth = (dep)}
+#define ENEMY(sym, n, col, hlth, atk, def, cn, spd, dep, behaviour, pk, fac) { \
+		.mob = {.symbol = (sym), .colour = (col), .name = (n), .is_bold = false,\
+		        .hostile = true, .faction = (fac),\
+		        .level = NULL,\
+		        .score = 0,\
+		        .darksight = true, .luminosity = 0,\
+		        .min_depth = (dep)},\
+		.stats = {.max_health = (hlth),\
+		          .attack = (atk), .defense = (def), .con = (cn),\
+		          .speed = (spd)},\
+		.ai = (behaviour), .pack = (pk)}
 
 /* should keep the same structure as EnemyType in enemy.h.
  * should also be ordered by dep. */
-const struct Mob default_enemies[] = {
-	ENEMY('H', "Hedgehog",     COLOR_YELLOW, 5,  1,  0,   0,  0),
-	ENEMY('S', "Squirrel",     COLOR_YELLOW, 10, 2,  0,   0,  0),
-	ENEMY('d', "Duck",         COLOR_GREEN,  10, 1,  1,   1,  1),
-	ENEMY('g', "Goose",        COLOR_WHITE,  15, 2,  2,   2,  2),
-	ENEMY('o', "Orc",          COLOR_YELLOW, 15, 3,  2,   7,  2),
-	ENEMY('P', "Cave Pirate",  COLOR_RED,    20, 3,  3,   5,  5),
-	ENEMY('W', "Wolfman",      COLOR_YELLOW, 25, 10, 3,   10, 10),
-	ENEMY('A', "Fallen Angel", COLOR_YELLOW, 50, 12, 10,  100, 25),
-	ENEMY('D', "Dragon",       COLOR_RED,    100,10, 10,  100, 30)
+const EnemyTemplate default_enemies[] = {
+	ENEMY('H', "Hedgehog",     COLOR_YELLOW, 5,  1,  0,   0,   5,  0,  AI_SIMPLE, 0, FACTION_BEASTS),
+	ENEMY('S', "Squirrel",     COLOR_YELLOW, 10, 2,  0,   0,   15, 0,  AI_SIMPLE, 0, FACTION_BEASTS),
+	ENEMY('d', "Duck",         COLOR_GREEN,  10, 1,  1,   1,   10, 1,  AI_SIMPLE, 0, FACTION_BEASTS),
+	ENEMY('g', "Goose",        COLOR_WHITE,  15, 2,  2,   2,   10, 2,  AI_SIMPLE, 0, FACTION_BEASTS),
+	ENEMY('o', "Orc",          COLOR_YELLOW, 15, 3,  2,   7,   10, 2,  AI_SIMPLE, 0, FACTION_ORCS),
+	ENEMY('P', "Cave Pirate",  COLOR_RED,    20, 3,  3,   5,   10, 5,  AI_HUNTER, 2, FACTION_PIRATES),
+	ENEMY('W', "Wolfman",      COLOR_YELLOW, 25, 10, 3,   10,  15, 10, AI_HUNTER, 2, FACTION_MONSTERS),
+	ENEMY('A', "Fallen Angel", COLOR_YELLOW, 50, 12, 10,  100, 10, 25, AI_SIMPLE, 0, FACTION_MONSTERS),
+	ENEMY('D', "Dragon",       COLOR_RED,    100,10, 10,  100, 7,  30, AI_SIMPLE, 0, FACTION_DRAGONS)
 };
 
 #undef ENEMY
 
 /**
- * Create and return an enemy of the specified type.
+ * Create and return an enemy of the specified type. The enemy belongs
+ * to the level, but has not been placed in it yet.
+ * @param level The level to create the mob in.
  * @param mobtype The type of mob to make.
  * @return The mob created.
  */
-Mob * create_enemy(enum EnemyType mobtype){
+Mob * create_enemy(Level * level, enum EnemyType mobtype){
 	Mob * new = xalloc(Mob);
-	memcpy(new, &default_enemies[mobtype], sizeof(Mob));
-	new->turn_action = &simple_enemy_turn;
-	new->death_action = &drop_corpse;
+	memcpy(new, &default_enemies[mobtype].mob, sizeof(Mob));
+	register_mob(level, new);
+
+	*mob_stats(new) = default_enemies[mobtype].stats;
+	mob_health(new) = mob_stats(new)->max_health;
+	mob_ai(new) = default_enemies[mobtype].ai;
+	new->death_action = (mob_ai(new) == AI_HUNTER) ? &hunter_death : &drop_corpse;
 
 	if (mobtype == ORC){
 		Item * sword = clone_item(O_SWORD);
-		new->inventory = insert(new->inventory, &sword->inventory);
+		list_insert(&new->inventory, &sword->inventory);
 		wield_item(new, sword);
 
-		if (rand() % 2) {
+		if (rng_below(level_rng(level, RNG_GEN), 2)) {
 			Item * food = clone_item(FOOD_RATION);
-			new->inventory = insert(new->inventory, &food->inventory);
+			list_insert(&new->inventory, &food->inventory);
 		}
 	} else if(mobtype == CAVE_PIRATE) {
-		new->turn_action = &hunter_turn;
-		new->death_action = &hunter_death;
-
 		Item * food = clone_item(HARD_TACK);
-		new->inventory = insert(new->inventory, &food->inventory);
+		list_insert(&new->inventory, &food->inventory);
 
 		Item * cutlass = clone_item(CUTLASS);
-		new->inventory = insert(new->inventory, &cutlass->inventory);
+		list_insert(&new->inventory, &cutlass->inventory);
 		wield_item(new,cutlass);
 	} else if(mobtype == WOLFMAN) {
-		new->turn_action = &hunter_turn;
-		new->death_action = &hunter_death;
-
 		Item * food = clone_item(N_FOOD_RATION);
-		new->inventory = insert(new->inventory, &food->inventory);
+		list_insert(&new->inventory, &food->inventory);
 	} else if(mobtype == FALLEN_ANGEL) {
 		Item * sword = clone_item(F_SWORD);
-		new->inventory = insert(new->inventory, &sword->inventory);
+		list_insert(&new->inventory, &sword->inventory);
 		wield_item(new, sword);
 
 		Item * food = clone_item(MANNA);
-		new->inventory = insert(new->inventory, &food->inventory);
+		list_insert(&new->inventory, &food->inventory);
 
 		new->is_bold = true;
 		new->luminosity = 1;
@@ -90,7 +98,7 @@ Mob * create_enemy(enum EnemyType mobtype){
 		wield_item(new, weapon);
 
 		Item * armour = clone_item(D_MAIL);
-		new->inventory = insert(new->inventory, &armour->inventory);
+		list_insert(&new->inventory, &armour->inventory);
 		new->armour = armour;
 	}
 
@@ -98,38 +106,63 @@ Mob * create_enemy(enum EnemyType mobtype){
 }
 
 /**
- * Move an enemy randomly, not including diagonals.
- * @param enemy Enemy to move
+ * Decide to take a step, digging if it's into rock the enemy can dig.
+ * @param enemy The enemy
+ * @param dx The X step
+ * @param dy The Y step
+ * @param intent The intent to fill in
  */
-void random_move(Mob * enemy) {
-	if(rand() % 2) {
-		move_mob_relative(enemy, (rand() % 2) ? 1 : -1, 0);
+void decide_step(Mob * enemy, int dx, int dy, Intent * intent) {
+	Cell * target = enemy->level->cells[mob_xpos(enemy) + dx][mob_ypos(enemy) + dy];
+
+	intent->kind = (enemy->weapon != NULL && enemy->weapon->can_dig &&
+	                target->solid && target->baseSymbol == '#')
+		? INTENT_DIG : INTENT_MOVE;
+	intent->dx = dx;
+	intent->dy = dy;
+}
+
+/**
+ * Decide on a random step, not including diagonals.
+ * @param enemy The enemy
+ * @param rng The decision's generator
+ * @param intent The intent to fill in
+ */
+void decide_random(Mob * enemy, Rng * rng, Intent * intent) {
+	if(rng_below(rng, 2)) {
+		decide_step(enemy, rng_below(rng, 2) ? 1 : -1, 0, intent);
 	} else {
-		move_mob_relative(enemy, 0, (rand() % 2) ? 1 : -1);
+		decide_step(enemy, 0, rng_below(rng, 2) ? 1 : -1, intent);
 	}
 }
 
 /**
- * Move an enemy randomly, including diagonals.
- * @param enemy Enemy to move
+ * Decide on a random step, including diagonals.
+ * @param enemy The enemy
+ * @param rng The decision's generator
+ * @param intent The intent to fill in
  */
-void random_move_diagonals(Mob * enemy) {
-	move_mob_relative(enemy, (rand() % 3) - 1, (rand() % 3) - 1);
+void decide_random_diagonals(Mob * enemy, Rng * rng, Intent * intent) {
+	int dx = (int) rng_below(rng, 3) - 1;
+	int dy = (int) rng_below(rng, 3) - 1;
+	decide_step(enemy, dx, dy, intent);
 }
 
 /**
- * Move towards a position. If the move fails, another axis will be
- * tried.
- * @param enemy Enemy to move
+ * Decide on a step towards a position, along the axis furthest away,
+ * with a step along the other axis to fall back on.
+ * @param enemy The enemy
  * @param x Target X
  * @param y Target Y
  * @param diagonal Can move diagonally
+ * @param intent The intent to fill in
  */
-void move_towards(Mob * enemy,
-                  unsigned int x, unsigned int y,
-                  bool diagonal) {
-	int xdiff = enemy->xpos - x;
-	int ydiff = enemy->ypos - y;
+void decide_towards(Mob * enemy,
+                    unsigned int x, unsigned int y,
+                    bool diagonal,
+                    Intent * intent) {
+	int xdiff = mob_xpos(enemy) - x;
+	int ydiff = mob_ypos(enemy) - y;
 
 	int dx = 0;
 	int dy = 0;
@@ -149,98 +182,298 @@ void move_towards(Mob * enemy,
 		}
 	}
 
-	/* Move along the axis furthest away from the target */
+	/* Move along the axis furthest away from the target, and if
+	   there's something solid in the way, try the other */
 	if(abs(xdiff) > abs(ydiff)) {
-		bool res = move_mob_relative(enemy, (xdiff < 0) ? 1 : -1, dy);
-
-		/* If there was something solid in the way, try moving y */
-		if(!res) {
-			move_mob_relative(enemy, dx, (ydiff < 0) ? 1 : -1);
-		}
+		decide_step(enemy, (xdiff < 0) ? 1 : -1, dy, intent);
+		intent->altdx = dx;
+		intent->altdy = (ydiff < 0) ? 1 : -1;
 	} else {
-		bool res = move_mob_relative(enemy, dx, (ydiff < 0) ? 1 : -1);
-
-		if(!res) {
-			move_mob_relative(enemy, (xdiff < 0) ? 1 : -1, dy);
-		}
+		decide_step(enemy, dx, (ydiff < 0) ? 1 : -1, intent);
+		intent->altdx = (xdiff < 0) ? 1 : -1;
+		intent->altdy = dy;
 	}
 }
 
 /**
- * A very simple enemy: move towards the player, and damage them if adjacent.
- * @param enemy Entity to move.
+ * Decide on a step down one of the level's distance maps, with the
+ * next best step to fall back on.
+ * @param enemy The enemy
+ * @param goal The map to descend
+ * @param diagonal Can move diagonally
+ * @param intent The intent to fill in
+ * @return false if there's no step closer to the goal
  */
-void simple_enemy_turn(Mob * enemy) {
-	Mob * player = enemy->level->player;
+bool decide_descend(Mob * enemy, enum DistanceGoal goal, bool diagonal,
+                    Intent * intent) {
+	const DistanceMap * map = distance_map(enemy->level, goal, diagonal);
+	int dx, dy, altdx, altdy;
+
+	if(map == NULL ||
+	   !distance_map_step(map, enemy->level,
+	                      mob_xpos(enemy), mob_ypos(enemy),
+	                      diagonal,
+	                      &dx, &dy, &altdx, &altdy)) {
+		return false;
+	}
 
-	/* If we can't see the player, move randomly */
-	if(!can_see_other(enemy, player)) {
-		random_move(enemy);
-		return;
+	decide_step(enemy, dx, dy, intent);
+	intent->altdx = altdx;
+	intent->altdy = altdy;
+	return true;
+}
+
+/**
+ * Decide on the first step of a path to a position, planned over the
+ * level's regions.
+ * @param enemy The enemy
+ * @param finder The storage to search with
+ * @param x Target X
+ * @param y Target Y
+ * @param intent The intent to fill in
+ * @return false if there's no path, or the enemy is already there
+ */
+bool decide_path(Mob * enemy, PathFinder * finder,
+                 unsigned int x, unsigned int y,
+                 Intent * intent) {
+	PathOptions options = {.diagonal = true};
+	PathStep step;
+
+	unsigned int length = find_long_path(finder, enemy->level,
+	                                     mob_xpos(enemy), mob_ypos(enemy),
+	                                     x, y, &options, &step, 1);
+	if(length == PATH_NONE || length == 0) {
+		return false;
 	}
 
-	int xdiff = enemy->xpos - player->xpos;
-	int ydiff = enemy->ypos - player->ypos;
+	decide_step(enemy, step.dx, step.dy, intent);
+	return true;
+}
+
+/**
+ * Move an enemy randomly, not including diagonals.
+ * @param enemy Enemy to move
+ */
+void random_move(Mob * enemy) {
+	Intent intent = {.kind = INTENT_WAIT};
 
-	if((abs(xdiff) == 1 && ydiff == 0)
-	   || (xdiff == 0 && abs(ydiff) == 1)) {
-		/* If (orthogonally) adjacent to the player, damage them */
-		attack_mob(enemy, player);
-	} else {
-		/* Move along the axis furthest away from the player */
-		move_towards(enemy, player->xpos, player->ypos, false);
+	decide_random(enemy, level_rng(enemy->level, RNG_AI), &intent);
+	apply_intent(enemy, &intent);
+}
+
+/**
+ * Move an enemy randomly, including diagonals.
+ * @param enemy Enemy to move
+ */
+void random_move_diagonals(Mob * enemy) {
+	Intent intent = {.kind = INTENT_WAIT};
+
+	decide_random_diagonals(enemy, level_rng(enemy->level, RNG_AI), &intent);
+	apply_intent(enemy, &intent);
+}
+
+/**
+ * Move towards a position. If the move fails, another axis will be
+ * tried.
+ * @param enemy Enemy to move
+ * @param x Target X
+ * @param y Target Y
+ * @param diagonal Can move diagonally
+ */
+void move_towards(Mob * enemy,
+                  unsigned int x, unsigned int y,
+                  bool diagonal) {
+	Intent intent = {.kind = INTENT_WAIT};
+
+	decide_towards(enemy, x, y, diagonal, &intent);
+	apply_intent(enemy, &intent);
+}
+
+/**
+ * Check if an enemy is only wandering about, rather than doing
+ * anything to do with the player or fighting something else.
+ * @param enemy Enemy to check
+ */
+bool is_wandering(Mob * enemy) {
+	if(nearest_foe(enemy, FOE_RADIUS) != NULL) {
+		return false;
+	}
+
+	int dx, dy;
+
+	switch(mob_ai(enemy)) {
+	case AI_SIMPLE:
+		/* One in sight of the player closes in on them */
+		return enemy->level->player == NULL ||
+			!can_see_other(enemy, enemy->level->player);
+	case AI_HUNTER:
+		/* Following the player's scent is tracking them down */
+		return !((HunterState *) enemy->data)->chase &&
+			!scent_step(enemy->level, mob_xpos(enemy), mob_ypos(enemy), &dx, &dy);
+	default:
+		return false;
 	}
 }
 
 /**
- * A more sophisticated enemy: hunters share their data field, and use
- * it to instantly communicate the player position.  The behaviour is
- * as follows: wander randomly (including diagonals) if the player
- * hasn't been seen, and all home in on the player as soon as one sees
- * them.
- * @param enemy Entity to move
+ * A standard normally-distributed random number (Box-Muller).
+ * @param rng The generator to draw from
  */
-void hunter_turn(Mob * enemy) {
-	assert(enemy->data != NULL);
+static double random_normal(Rng * rng) {
+	const double pi = 3.14159265358979323846;
 
-	Mob * player = enemy->level->player;
-	HunterState * data = (HunterState *) enemy->data;
+	double u1 = rng_unit(rng);
+	double u2 = rng_unit(rng);
+
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * pi * u2);
+}
+
+/**
+ * Check if a wandering enemy could have ended up in a cell: open,
+ * free, and connected to where it is.
+ * @param enemy The enemy
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ */
+static bool can_wander_to(Mob * enemy, int x, int y) {
+	if(x < 0 || x >= LEVELWIDTH || y < 0 || y >= LEVELHEIGHT) {
+		return false;
+	}
 
-	int xdiff = enemy->xpos - player->xpos;
-	int ydiff = enemy->ypos - player->ypos;
+	Cell * cell = enemy->level->cells[x][y];
+	return !cell->solid && cell->occupant == NO_MOB &&
+		reachable(enemy->level, mob_xpos(enemy), mob_ypos(enemy), x, y);
+}
 
-	/* If (diagonally) adjacent to the player, damage them */
-	if((abs(xdiff) == 1 && ydiff == 0)
-	   || (xdiff == 0 && abs(ydiff) == 1)
-	   || (abs(xdiff) == 1 && abs(ydiff) == 1)) {
-		attack_mob(enemy, player);
+/**
+ * Advance a wandering enemy by a number of random moves in one
+ * go. The displacement is drawn from the distribution a random walk of
+ * that many moves has, and the enemy is put in the nearest cell to
+ * where that lands which it could have walked to. If there is none
+ * within CATCH_UP_SEARCH, it stays where it is.
+ * @param enemy Enemy to move
+ * @param moves The number of moves to catch up on
+ */
+void catch_up_wander(Mob * enemy, unsigned long moves) {
+	if(moves == 0) {
 		return;
 	}
 
-	/* Player found, update the shared state */
-	if(can_see_other(enemy, player)) {
-		data->x = player->xpos;
-		data->y = player->ypos;
-		data->chase = true;
-	} else if(data->chase &&
-	          can_see_point(enemy->level,
-	                        enemy->xpos, enemy->ypos,
-	                        data->x, data->y)) {
-		/* If we can see the target, but not the player, return to wandering */
-		data->chase = false;
+	/* random_move changes one axis by one each move, which is a
+	   variance of 1/2 per axis; random_move_diagonals changes each
+	   axis by -1, 0, or 1, which is a variance of 2/3 */
+	double variance = (mob_ai(enemy) == AI_HUNTER) ? moves * 2.0 / 3.0 : moves / 2.0;
+	double sd = sqrt(variance);
+
+	int x0 = mob_xpos(enemy);
+	int y0 = mob_ypos(enemy);
+	int x1 = x0 + (int) lround(random_normal(level_rng(enemy->level, RNG_AI)) * sd);
+	int y1 = y0 + (int) lround(random_normal(level_rng(enemy->level, RNG_AI)) * sd);
+
+	x1 = (x1 < 0) ? 0 : (x1 >= LEVELWIDTH)  ? LEVELWIDTH - 1  : x1;
+	y1 = (y1 < 0) ? 0 : (y1 >= LEVELHEIGHT) ? LEVELHEIGHT - 1 : y1;
+
+	/* Search rings of cells further and further out from where it
+	   lands, stopping at the enemy itself if that's nearer */
+	for(int r = 0; r <= CATCH_UP_SEARCH; r++) {
+		if(abs(x1 - x0) <= r && abs(y1 - y0) <= r) {
+			return;
+		}
+
+		for(int dx = -r; dx <= r; dx++) {
+			for(int dy = -r; dy <= r; dy++) {
+				/* Only the edge of the ring is new */
+				if(abs(dx) != r && abs(dy) != r) {
+					continue;
+				}
+
+				if(can_wander_to(enemy, x1 + dx, y1 + dy)) {
+					move_mob(enemy, x1 + dx, y1 + dy);
+					return;
+				}
+			}
+		}
 	}
+}
 
-	/* If the chase is on, pursue */
-	if (data->chase) {
-		move_towards(enemy,
-		             data->x, data->y,
-		             true);
-	} else {
-		/* No information: move randomly */
+/**
+ * Carry out an intent. Steps which have since been blocked fall back
+ * to the alternative (if any), and attacks on targets which have
+ * since died or moved away become waits.
+ * @param enemy The enemy
+ * @param intent What it decided to do
+ */
+void apply_intent(Mob * enemy, const Intent * intent) {
+	if(mob_ai(enemy) == AI_HUNTER) {
+		HunterState * data = (HunterState *) enemy->data;
+
+		if(intent->sighted) {
+			/* Dormant hunters can't see the chase start, so are told */
+			if(!data->chase) {
+				wake_pack(enemy);
+			}
+			data->x = intent->seenx;
+			data->y = intent->seeny;
+			data->chase = true;
+		} else if(intent->lost) {
+			data->chase = false;
+		}
+	}
+
+	switch(intent->kind) {
+	case INTENT_WAIT:
+		break;
+	case INTENT_MOVE:
+	case INTENT_DIG:
+		if(!move_mob_relative(enemy, intent->dx, intent->dy) &&
+		   (intent->altdx != 0 || intent->altdy != 0)) {
+			move_mob_relative(enemy, intent->altdx, intent->altdy);
+		}
+		break;
+	case INTENT_ATTACK: {
+		/* Weapons which hit an area reach as far as the area */
+		Mob * target = mobtable_get(&enemy->level->mobtable, intent->target);
+		if(target == NULL || mob_health(target) <= 0) {
+			break;
+		}
+
+		bool reaches = (enemy->weapon != NULL && enemy->weapon->area != AREA_NONE)
+			? area_reaches(enemy, mob_xpos(target), mob_ypos(target))
+			: (abs((int) mob_xpos(enemy) - (int) mob_xpos(target)) <= 1 &&
+			   abs((int) mob_ypos(enemy) - (int) mob_ypos(target)) <= 1);
+		if(reaches) {
+			attack_mob(enemy, target);
+		}
+		break;
+	}
+	}
+}
+
+/**
+ * Take a turn without thinking about it, by wandering about. This is
+ * for when there's no time left to think.
+ * @param enemy Entity to move
+ */
+void idle_turn(Mob * enemy) {
+	if(mob_ai(enemy) == AI_HUNTER) {
 		random_move_diagonals(enemy);
+	} else {
+		random_move(enemy);
 	}
 }
 
+/**
+ * Take an enemy's turn, deciding with the behaviour tree of its AI
+ * (see behaviour.c).
+ * @param enemy Entity to move.
+ */
+void enemy_turn(Mob * enemy) {
+	Intent intent;
+
+	decide_turn(enemy, level_rng(enemy->level, RNG_AI), level_path_finder(enemy->level), &intent);
+	apply_intent(enemy, &intent);
+}
+
 /**
  * Free a hunter's state. As hunters share the state, there is a count
  * of how many hunters are still surviving.
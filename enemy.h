@@ -3,6 +3,13 @@
 
 #include <stdbool.h>
 #include "mob.h"
+#include "level.h"
+#include "astar.h"
+#include "distmap.h"
+
+/** How far from where a sleeping enemy's wandering lands it may end up
+ * instead, if that cell is blocked (see catch_up_wander). */
+#define CATCH_UP_SEARCH 8
 
 /* should keep the same structure as default_mobs in enemy.c */
 enum EnemyType { HEDGEHOG, SQUIRREL, DUCK, GOOSE, ORC, CAVE_PIRATE, WOLFMAN, FALLEN_ANGEL, DRAGON, NUM_ENEMY_TYPES };
@@ -17,7 +24,39 @@ typedef struct HunterState {
 	unsigned int refcount; /**< Number of hunters sharing this state */
 } HunterState;
 
-Mob * create_enemy(enum EnemyType mobtype);
+/**
+ * The template an enemy is created from
+ */
+typedef struct EnemyTemplate {
+	Mob mob;        /**< The mob to copy */
+	MobStats stats; /**< The starting stats (health starts at the maximum) */
+	enum MobAI ai;  /**< How it behaves (see behaviour.h) */
+	unsigned int pack; /**< For hunters, how many turn up together, sharing what they know */
+} EnemyTemplate;
+
+/**
+ * The things an enemy can decide to do with a turn.
+ */
+enum IntentKind { INTENT_WAIT, INTENT_MOVE, INTENT_DIG, INTENT_ATTACK };
+
+/**
+ * What an enemy has decided to do with a turn. Deciding only looks at
+ * the level, so many enemies can decide at once; the intents are then
+ * applied one at a time, by which point the chosen step may be taken
+ * or the target gone.
+ */
+typedef struct Intent {
+	enum IntentKind kind; /**< What to do */
+	int dx, dy;           /**< The step to take, for moves and digs */
+	int altdx, altdy;     /**< The step to try if that is blocked (0, 0 for none) */
+	MobId target;         /**< The mob to attack */
+	bool sighted;         /**< Whether the player was seen (hunters) */
+	bool lost;            /**< Whether the trail has gone cold (hunters) */
+	unsigned int seenx;   /**< Where the player was seen, if sighted */
+	unsigned int seeny;   /**< Where the player was seen, if sighted */
+} Intent;
+
+Mob * create_enemy(Level * level, enum EnemyType mobtype);
 
 void random_move(Mob * enemy);
 void random_move_diagonals(Mob * enemy);
@@ -25,8 +64,25 @@ void move_towards(Mob * enemy,
                   unsigned int x, unsigned int y,
                   bool diagonal);
 
-void simple_enemy_turn(Mob * enemy);
-void hunter_turn(Mob * enemy);
+bool is_wandering(Mob * enemy);
+void catch_up_wander(Mob * enemy, unsigned long moves);
+
+void decide_step(Mob * enemy, int dx, int dy, Intent * intent);
+void decide_random(Mob * enemy, Rng * rng, Intent * intent);
+void decide_random_diagonals(Mob * enemy, Rng * rng, Intent * intent);
+void decide_towards(Mob * enemy,
+                    unsigned int x, unsigned int y,
+                    bool diagonal,
+                    Intent * intent);
+bool decide_descend(Mob * enemy, enum DistanceGoal goal, bool diagonal,
+                    Intent * intent);
+bool decide_path(Mob * enemy, PathFinder * finder,
+                 unsigned int x, unsigned int y,
+                 Intent * intent);
+void apply_intent(Mob * enemy, const Intent * intent);
+
+void idle_turn(Mob * enemy);
+void enemy_turn(Mob * enemy);
 
 void hunter_death(Mob * enemy);
 
@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "event.h"
+#include "level.h"
+#include "enemy.h"
+#include "schedule.h"
+#include "utils.h"
+
+/**
+ * The current turn of a level.
+ * @param level The level
+ */
+static unsigned long current_turn(const Level * level) {
+	return level->time / TURN_TICKS;
+}
+
+/**
+ * Schedule an event in a level.
+ * @param level The level
+ * @param turns The number of turns from now the event happens
+ * @param kind What happens
+ * @param x The X of the cell it happens in
+ * @param y The Y of the cell it happens in
+ * @return The turn it is due
+ */
+unsigned long queue_event(Level * level, unsigned long turns,
+                 enum EventKind kind, unsigned int x, unsigned int y) {
+	EventQueue * queue = &level->events;
+	unsigned int index;
+
+	if(queue->num_free > 0) {
+		index = queue->free[-- queue->num_free];
+	} else {
+		if(queue->used == queue->capacity) {
+			queue->capacity = (queue->capacity == 0) ? 16 : queue->capacity * 2;
+			queue->events = xrealloc(queue->events, queue->capacity, Event);
+			queue->free = xrealloc(queue->free, queue->capacity, unsigned int);
+		}
+		index = queue->used ++;
+	}
+
+	unsigned long due = current_turn(level) + turns;
+	queue->events[index] = (Event) {.kind = kind, .x = x, .y = y};
+	heap_push(&queue->heap, due, index);
+	return due;
+}
+
+/**
+ * Rot away a corpse (or pile of them) in a cell.
+ * @param cell The cell
+ * @param turn The turn it rots on
+ */
+static void rot_corpse(Cell * cell, unsigned long turn) {
+	/* Corpses are recognised as drop_corpse recognises them */
+	list_foreach(Item, inventory, item, &cell->items) {
+		if(item->value == 4 && item->type == FOOD && item->expires == turn) {
+			list_drop(&cell->items, &item->inventory);
+			xfree(item);
+			return;
+		}
+	}
+}
+
+/**
+ * Put out a lantern lying in a cell.
+ * @param cell The cell
+ * @param turn The turn it goes out on
+ */
+static void lantern_out(Cell * cell, unsigned long turn) {
+	list_foreach(Item, inventory, item, &cell->items) {
+		if(item->luminous && item->burns_out && item->expires == turn) {
+			item->luminous = false;
+			item->name = "Spent Lantern";
+			cell->luminosity --;
+			return;
+		}
+	}
+}
+
+/**
+ * Have an enemy wander into a level, and schedule the next to.
+ * @param level The level
+ */
+static void spawn(Level * level) {
+	if(level->mobtable.count < SPAWN_MAX_MOBS) {
+		spawn_enemy(level);
+	}
+
+	queue_event(level,
+	            SPAWN_MIN_TURNS + rng_below(level_rng(level, RNG_GEN), SPAWN_MAX_TURNS - SPAWN_MIN_TURNS + 1),
+	            EVENT_SPAWN, 0, 0);
+}
+
+/**
+ * Make everything happen which is due to by the current turn.
+ * @param level The level
+ */
+void run_events(Level * level) {
+	EventQueue * queue = &level->events;
+	HeapEntry entry;
+
+	while(heap_peek(&queue->heap, &entry) && entry.key <= current_turn(level)) {
+		heap_pop(&queue->heap, NULL);
+
+		Event event = queue->events[entry.value];
+		queue->free[queue->num_free ++] = entry.value;
+
+		switch(event.kind) {
+		case EVENT_CORPSE_ROT:
+			rot_corpse(level->cells[event.x][event.y], entry.key);
+			break;
+		case EVENT_LANTERN_OUT:
+			lantern_out(level->cells[event.x][event.y], entry.key);
+			break;
+		case EVENT_SPAWN:
+			spawn(level);
+			break;
+		}
+	}
+}
+
+/**
+ * Free the storage of an event queue.
+ * @param queue The queue
+ */
+void free_events(EventQueue * queue) {
+	heap_free(&queue->heap);
+	xfree(queue->events);
+	xfree(queue->free);
+}
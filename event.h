@@ -0,0 +1,58 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include "heap.h"
+
+struct Level;
+
+/** The turns a corpse lies about before rotting away. */
+#define CORPSE_ROT_TURNS 200
+
+/** The turns a dropped lantern stays lit. */
+#define LANTERN_TURNS 300
+
+/** The least and most turns between new enemies wandering into a level. */
+#define SPAWN_MIN_TURNS 150
+#define SPAWN_MAX_TURNS 400
+
+/** Enemies stop wandering into a level once it has this many mobs. */
+#define SPAWN_MAX_MOBS 20
+
+/**
+ * The things which can happen in a level at a set time.
+ */
+enum EventKind { EVENT_CORPSE_ROT, EVENT_LANTERN_OUT, EVENT_SPAWN };
+
+/**
+ * Something scheduled to happen in a level. Events are plain data,
+ * referring to things by position rather than pointer, so that they
+ * can be stored along with the level; if whatever they refer to has
+ * gone by the time they happen, nothing happens. An event for an item
+ * is for the one in its cell which expires on the turn it is due, so
+ * an item dropped there since is left alone.
+ */
+typedef struct Event {
+	enum EventKind kind; /**< What happens */
+	unsigned int x;      /**< The X of the cell it happens in */
+	unsigned int y;      /**< The Y of the cell it happens in */
+} Event;
+
+/**
+ * The events waiting to happen in a level, by turn. A zeroed
+ * EventQueue is empty.
+ */
+typedef struct EventQueue {
+	Heap heap;              /**< The index of each event, keyed by its turn. */
+	Event * events;         /**< The events, by index. */
+	unsigned int capacity;  /**< The number of events allocated. */
+	unsigned int * free;    /**< Stack of indices available for reuse. */
+	unsigned int num_free;  /**< The number of indices available for reuse. */
+	unsigned int used;      /**< The number of indices ever handed out. */
+} EventQueue;
+
+unsigned long queue_event(struct Level * level, unsigned long turns,
+                 enum EventKind kind, unsigned int x, unsigned int y);
+void run_events(struct Level * level);
+void free_events(EventQueue * queue);
+
+#endif /* EVENT_H */
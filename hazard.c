@@ -0,0 +1,219 @@
+#include <string.h>
+
+#include "hazard.h"
+#include "utils.h"
+
+/** The share of each hazard kept from one turn to the next. */
+static const float decay[NUM_HAZARDS] = {
+	[HAZARD_FIRE] = 0.85f,
+	[HAZARD_GAS]  = 0.95f
+};
+
+/** The share of each hazard mixed with its neighbours each turn. */
+static const float spread[NUM_HAZARDS] = {
+	[HAZARD_FIRE] = 0.6f,
+	[HAZARD_GAS]  = 0.6f
+};
+
+/** The gas a poison lake gives off each turn. */
+#define GAS_LEAK 0.05f
+
+/** The fire a cell catching alight starts with. */
+#define FIRE_IGNITE 3.0f
+
+/**
+ * The hazard map of a level, made if it doesn't have one.
+ * @param level The level
+ */
+static HazardMap * hazard_map(Level * level) {
+	if(level->hazards == NULL) {
+		level->hazards = xalloc(HazardMap);
+		level->hazards->epoch = level->terrain_epoch - 1;
+	}
+
+	return level->hazards;
+}
+
+/**
+ * Work out which cells are open and which leak, if the terrain has
+ * changed since it was last done.
+ * @param level The level
+ * @param map The hazard map
+ */
+static void refresh_terrain(Level * level, HazardMap * map) {
+	if(map->epoch == level->terrain_epoch) {
+		return;
+	}
+
+	memset(map->source, 0, sizeof(map->source));
+
+	for(unsigned int x = 0; x < LEVELWIDTH; x++) {
+		for(unsigned int y = 0; y < LEVELHEIGHT; y++) {
+			const Cell * cell = level->cells[x][y];
+			bool lake = cell->baseSymbol == '~' && !cell->solid;
+
+			map->open[x][y] = cell->solid ? 0.0f : 1.0f;
+			map->leak[x][y] = lake ? GAS_LEAK : 0.0f;
+			if(lake) {
+				map->source[x / HAZARD_TILE][y / HAZARD_TILE] = true;
+			}
+		}
+	}
+
+	map->epoch = level->terrain_epoch;
+}
+
+/**
+ * Set a cell alight.
+ * @param level The level
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ */
+void ignite(Level * level, unsigned int x, unsigned int y) {
+	HazardMap * map = hazard_map(level);
+
+	map->field[HAZARD_FIRE][map->current][x][y] = FIRE_IGNITE;
+	map->active[x / HAZARD_TILE][y / HAZARD_TILE] = true;
+	map->stale[map->current][x / HAZARD_TILE][y / HAZARD_TILE] = true;
+}
+
+/**
+ * Spread and fade one hazard over one tile by a turn, clearing away
+ * anything too faint to keep.
+ * @param map The hazard map
+ * @param hazard The hazard
+ * @param tx The X of the tile
+ * @param ty The Y of the tile
+ * @return Whether anything is left in the tile
+ */
+static bool spread_tile(HazardMap * map, enum Hazard hazard, unsigned int tx, unsigned int ty) {
+	float (*from)[LEVELHEIGHT] = map->field[hazard][map->current];
+	float (*to)[LEVELHEIGHT] = map->field[hazard][!map->current];
+	const float keep = decay[hazard] * (1.0f - spread[hazard]);
+	const float share = decay[hazard] * spread[hazard] / 4.0f;
+	const float leaks = (hazard == HAZARD_GAS) ? 1.0f : 0.0f;
+
+	/* The border of a level is always solid, so is never worked out */
+	unsigned int x0 = (tx == 0) ? 1 : tx * HAZARD_TILE;
+	unsigned int y0 = (ty == 0) ? 1 : ty * HAZARD_TILE;
+	unsigned int x1 = ((tx + 1) * HAZARD_TILE < LEVELWIDTH - 1) ? (tx + 1) * HAZARD_TILE : LEVELWIDTH - 1;
+	unsigned int y1 = ((ty + 1) * HAZARD_TILE < LEVELHEIGHT - 1) ? (ty + 1) * HAZARD_TILE : LEVELHEIGHT - 1;
+
+	float most = 0.0f;
+	for(unsigned int x = x0; x < x1; x++) {
+		const float * restrict left = from[x - 1];
+		const float * restrict middle = from[x];
+		const float * restrict right = from[x + 1];
+		const float * restrict open = map->open[x];
+		const float * restrict leak = map->leak[x];
+		float * restrict out = to[x];
+
+		for(unsigned int y = y0; y < y1; y++) {
+			float value = open[y] * (keep * middle[y] +
+			                         share * (left[y] + right[y] + middle[y - 1] + middle[y + 1])) +
+				leaks * leak[y];
+			out[y] = (value >= HAZARD_FAINT) ? value : 0.0f;
+			most = (out[y] > most) ? out[y] : most;
+		}
+	}
+
+	return most > 0.0f;
+}
+
+/**
+ * Clear a tile of a buffer of every hazard.
+ * @param map The hazard map
+ * @param buffer The buffer
+ * @param tx The X of the tile
+ * @param ty The Y of the tile
+ */
+static void clear_tile(HazardMap * map, unsigned int buffer, unsigned int tx, unsigned int ty) {
+	unsigned int x1 = ((tx + 1) * HAZARD_TILE < LEVELWIDTH) ? (tx + 1) * HAZARD_TILE : LEVELWIDTH;
+	unsigned int y0 = ty * HAZARD_TILE;
+	unsigned int y1 = ((ty + 1) * HAZARD_TILE < LEVELHEIGHT) ? (ty + 1) * HAZARD_TILE : LEVELHEIGHT;
+
+	for(unsigned int hazard = 0; hazard < NUM_HAZARDS; hazard++) {
+		for(unsigned int x = tx * HAZARD_TILE; x < x1; x++) {
+			memset(&map->field[hazard][buffer][x][y0], 0, (y1 - y0) * sizeof(float));
+		}
+	}
+}
+
+/**
+ * Spread and fade the hazards of a level by a turn, and let more gas
+ * out of the lakes. Only the tiles which have something in them, have
+ * something leaking, or are next to one which does, are worked out.
+ * @param level The level
+ */
+void spread_hazards(Level * level) {
+	HazardMap * map = hazard_map(level);
+	bool work[HAZARD_TILES_X][HAZARD_TILES_Y];
+	bool any = false;
+
+	refresh_terrain(level, map);
+
+	for(unsigned int tx = 0; tx < HAZARD_TILES_X; tx++) {
+		for(unsigned int ty = 0; ty < HAZARD_TILES_Y; ty++) {
+			work[tx][ty] = map->source[tx][ty] || map->active[tx][ty] ||
+				(tx > 0 && map->active[tx - 1][ty]) ||
+				(tx + 1 < HAZARD_TILES_X && map->active[tx + 1][ty]) ||
+				(ty > 0 && map->active[tx][ty - 1]) ||
+				(ty + 1 < HAZARD_TILES_Y && map->active[tx][ty + 1]);
+			any = any || work[tx][ty];
+		}
+	}
+
+	if(!any) {
+		return;
+	}
+
+	unsigned int next = !map->current;
+	for(unsigned int tx = 0; tx < HAZARD_TILES_X; tx++) {
+		for(unsigned int ty = 0; ty < HAZARD_TILES_Y; ty++) {
+			if(!work[tx][ty]) {
+				/* Whatever's left from two turns ago is out of date */
+				if(map->stale[next][tx][ty]) {
+					clear_tile(map, next, tx, ty);
+					map->stale[next][tx][ty] = false;
+				}
+				map->active[tx][ty] = false;
+				continue;
+			}
+
+			bool left = false;
+			for(unsigned int hazard = 0; hazard < NUM_HAZARDS; hazard++) {
+				left = spread_tile(map, hazard, tx, ty) || left;
+			}
+			map->active[tx][ty] = left;
+			map->stale[next][tx][ty] = left;
+		}
+	}
+
+	map->current = next;
+}
+
+/**
+ * Find how much of a hazard is in a cell.
+ * @param level The level
+ * @param hazard The hazard
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ * @return The amount, 0 if there's none
+ */
+float hazard_at(const Level * level, enum Hazard hazard, unsigned int x, unsigned int y) {
+	const HazardMap * map = level->hazards;
+
+	if(map == NULL) {
+		return 0.0f;
+	}
+
+	return map->field[hazard][map->current][x][y];
+}
+
+/**
+ * Free the hazard map of a level.
+ * @param level The level
+ */
+void free_hazards(Level * level) {
+	xfree(level->hazards);
+}
@@ -0,0 +1,55 @@
+#ifndef HAZARD_H
+#define HAZARD_H
+
+#include <stdbool.h>
+
+#include "level.h"
+
+/** The width and height of a tile, the unit hazards are updated in. */
+#define HAZARD_TILE 8
+
+/** The number of tiles across a level. */
+#define HAZARD_TILES_X ((LEVELWIDTH + HAZARD_TILE - 1) / HAZARD_TILE)
+
+/** The number of tiles down a level. */
+#define HAZARD_TILES_Y ((LEVELHEIGHT + HAZARD_TILE - 1) / HAZARD_TILE)
+
+/** The least hazard which is kept: anything less is cleared away. */
+#define HAZARD_FAINT 0.01f
+
+/** The least hazard which harms what steps into it. */
+#define HAZARD_HARMFUL 0.2f
+
+/**
+ * The things which spread over a level.
+ */
+enum Hazard {
+	HAZARD_FIRE, /**< Fire, which catches from burning things and soon dies down. */
+	HAZARD_GAS,  /**< Poison gas, which leaks from lakes. */
+	NUM_HAZARDS
+};
+
+/**
+ * The hazards spreading over a level. Each turn every hazard is worked
+ * out afresh from the last into the other buffer, from each cell and
+ * its neighbours, with solid cells soaking it up. Only the tiles with
+ * something in them (and those next to them, which it may spread into)
+ * are worked out; the rest are known to be clear.
+ */
+typedef struct HazardMap {
+	float field[NUM_HAZARDS][2][LEVELWIDTH][LEVELHEIGHT]; /**< The current fields and the next. */
+	unsigned int current;                         /**< Which fields are current. */
+	float open[LEVELWIDTH][LEVELHEIGHT];          /**< 1 for open cells, 0 for solid ones. */
+	float leak[LEVELWIDTH][LEVELHEIGHT];          /**< The gas leaking from each cell a turn. */
+	unsigned long epoch;                          /**< The terrain epoch open and leak were worked out at. */
+	bool active[HAZARD_TILES_X][HAZARD_TILES_Y];  /**< The tiles with something in the current fields. */
+	bool stale[2][HAZARD_TILES_X][HAZARD_TILES_Y]; /**< The tiles of each buffer which may not be clear. */
+	bool source[HAZARD_TILES_X][HAZARD_TILES_Y];  /**< The tiles with something leaking. */
+} HazardMap;
+
+void ignite(Level * level, unsigned int x, unsigned int y);
+void spread_hazards(Level * level);
+float hazard_at(const Level * level, enum Hazard hazard, unsigned int x, unsigned int y);
+void free_hazards(Level * level);
+
+#endif /* HAZARD_H */
@@ -0,0 +1,123 @@
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "heap.h"
+#include "utils.h"
+
+/**
+ * Whether one entry should come out of the heap before another.
+ * @param a The first entry
+ * @param b The second entry
+ */
+static bool before(const HeapEntry * a, const HeapEntry * b) {
+	return (a->key < b->key) || (a->key == b->key && a->seq < b->seq);
+}
+
+/**
+ * Swap two entries of a heap.
+ * @param heap The heap
+ * @param i The index of the first entry
+ * @param j The index of the second entry
+ */
+static void swap(Heap * heap, unsigned int i, unsigned int j) {
+	HeapEntry tmp = heap->entries[i];
+	heap->entries[i] = heap->entries[j];
+	heap->entries[j] = tmp;
+}
+
+/**
+ * Add an entry to a heap.
+ * @param heap The heap to add to
+ * @param key The key of the entry
+ * @param value The payload of the entry
+ * @return The insertion number given to the entry
+ */
+unsigned long heap_push(Heap * heap, unsigned long key, unsigned int value) {
+	if(heap->size == heap->capacity) {
+		heap->capacity = (heap->capacity == 0) ? 16 : heap->capacity * 2;
+		heap->entries = xrealloc(heap->entries, heap->capacity, HeapEntry);
+	}
+
+	unsigned int i = heap->size;
+	heap->size ++;
+
+	heap->entries[i].key = key;
+	heap->entries[i].seq = heap->next_seq;
+	heap->entries[i].value = value;
+	heap->next_seq ++;
+
+	/* Sift up */
+	while(i > 0 && before(&heap->entries[i], &heap->entries[(i - 1) / 2])) {
+		swap(heap, i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+
+	return heap->next_seq - 1;
+}
+
+/**
+ * Look at the smallest entry of a heap without removing it.
+ * @param heap The heap
+ * @param out Where to store the entry
+ * @return false if the heap is empty
+ */
+bool heap_peek(const Heap * heap, HeapEntry * out) {
+	if(heap->size == 0) {
+		return false;
+	}
+
+	*out = heap->entries[0];
+	return true;
+}
+
+/**
+ * Remove the smallest entry of a heap.
+ * @param heap The heap
+ * @param out Where to store the entry (may be NULL)
+ * @return false if the heap is empty
+ */
+bool heap_pop(Heap * heap, HeapEntry * out) {
+	if(heap->size == 0) {
+		return false;
+	}
+
+	if(out != NULL) {
+		*out = heap->entries[0];
+	}
+
+	heap->size --;
+	heap->entries[0] = heap->entries[heap->size];
+
+	/* Sift down */
+	unsigned int i = 0;
+	while(true) {
+		unsigned int left = 2 * i + 1;
+		unsigned int right = left + 1;
+		unsigned int smallest = i;
+
+		if(left < heap->size && before(&heap->entries[left], &heap->entries[smallest])) {
+			smallest = left;
+		}
+		if(right < heap->size && before(&heap->entries[right], &heap->entries[smallest])) {
+			smallest = right;
+		}
+		if(smallest == i) {
+			break;
+		}
+
+		swap(heap, i, smallest);
+		i = smallest;
+	}
+
+	return true;
+}
+
+/**
+ * Free the storage of a heap.
+ * @param heap The heap to free
+ */
+void heap_free(Heap * heap) {
+	xfree(heap->entries);
+	memset(heap, 0, sizeof(Heap));
+}
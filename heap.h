@@ -0,0 +1,31 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stdbool.h>
+
+/**
+ * An entry in a heap. Entries with equal keys come out in the order
+ * they went in.
+ */
+typedef struct HeapEntry {
+	unsigned long key;   /**< The key to order by (smallest first). */
+	unsigned long seq;   /**< The insertion number, to break ties. */
+	unsigned int value;  /**< The payload. */
+} HeapEntry;
+
+/**
+ * A binary min-heap. A zeroed Heap is empty.
+ */
+typedef struct Heap {
+	HeapEntry * entries; /**< The entries, in heap order. */
+	unsigned int size;     /**< The number of entries. */
+	unsigned int capacity; /**< The number of entries allocated. */
+	unsigned long next_seq; /**< The insertion number of the next entry. */
+} Heap;
+
+unsigned long heap_push(Heap * heap, unsigned long key, unsigned int value);
+bool heap_peek(const Heap * heap, HeapEntry * out);
+bool heap_pop(Heap * heap, HeapEntry * out);
+void heap_free(Heap * heap);
+
+#endif /* HEAP_H */
@@ -11,21 +11,25 @@
 #include "effect.h"
 
 /** Definitions of special items. */
-#define ITEM(sym, n, t, val, dig, lit, range, eff, atkeff) {	  \
+#define ITEM(sym, n, t, val, dig, lit, burn, range, eff, atkeff, shape, reach) { \
 		.count = 1, .symbol = (sym), .name = (n), .type = (t),\
         .value = (val), .can_dig = (dig), .luminous = (lit),\
-		.ranged = (range), .effect = (eff), .fight_effect = (atkeff)}
-#define ITEM_D(sym, n, t, val) ITEM(sym, n, t, val, true, false, false, NULL, NULL)
-#define ITEM_L(sym, n, t, val) ITEM(sym, n, t, val, false, true, false, NULL, NULL)
-#define ITEM_N(sym, n, t, val) ITEM(sym, n, t, val, false, false, false, NULL, NULL)
-#define ITEM_F(sym, n, t, val, atkeff) ITEM(sym, n, t, val, false, false, false, NULL, atkeff)
-#define ITEM_R(sym, n, t, val) ITEM(sym, n, t, val, false, false, true, NULL, NULL)
-#define ITEM_E(sym, n, t, val, eff) ITEM(sym, n, t, val, false, false, false, eff, NULL)
+		.burns_out = (burn), .ranged = (range),\
+		.effect = (eff), .fight_effect = (atkeff),\
+		.area = (shape), .area_radius = (reach)}
+#define ITEM_D(sym, n, t, val) ITEM(sym, n, t, val, true, false, false, false, NULL, NULL, AREA_NONE, 0)
+#define ITEM_B(sym, n, t, val) ITEM(sym, n, t, val, false, true, true, false, NULL, NULL, AREA_NONE, 0)
+#define ITEM_L(sym, n, t, val) ITEM(sym, n, t, val, false, true, false, false, NULL, NULL, AREA_NONE, 0)
+#define ITEM_N(sym, n, t, val) ITEM(sym, n, t, val, false, false, false, false, NULL, NULL, AREA_NONE, 0)
+#define ITEM_F(sym, n, t, val, atkeff) ITEM(sym, n, t, val, false, false, false, false, NULL, atkeff, AREA_NONE, 0)
+#define ITEM_R(sym, n, t, val) ITEM(sym, n, t, val, false, false, false, true, NULL, NULL, AREA_NONE, 0)
+#define ITEM_E(sym, n, t, val, eff) ITEM(sym, n, t, val, false, false, false, false, eff, NULL, AREA_NONE, 0)
+#define ITEM_A(sym, n, t, val, atkeff, shape, reach) ITEM(sym, n, t, val, false, false, false, false, NULL, atkeff, shape, reach)
 
 /* Should keep the same structure as DefaultItem in item.h. */
 const struct Item default_items[] = {
 	ITEM_D('/', "Pickaxe",                WEAPON,  5),
-	ITEM_L('^', "Lantern",                WEAPON,  1),
+	ITEM_B('^', "Lantern",                WEAPON,  1),
 	ITEM_N('/', "Orcish Sword",           WEAPON,  5),
 	ITEM_N(']', "Helmet",                 ARMOUR,  3),
 	ITEM_N('/', "Sword",                  WEAPON, 10),
@@ -57,14 +61,16 @@ const struct Item default_items[] = {
 	ITEM_N('/', "Advanced Mining Pickaxe", WEAPON, 18),
 	ITEM_N('v', "Book of Tax Code Bound in Human Flesh", WEAPON, 15),
 	ITEM_R('c', "Wooden Boot",            WEAPON, 15),
-	ITEM_F('!', "Dragon Fire",            WEAPON, 20, &inflict_fire),
+	ITEM_A('!', "Dragon Fire",            WEAPON, 20, &inflict_fire, AREA_CONE, 3),
 };
 
+#undef ITEM_A
 #undef ITEM_E
 #undef ITEM_R
 #undef ITEM_F
 #undef ITEM_N
 #undef ITEM_L
+#undef ITEM_B
 #undef ITEM_D
 #undef ITEM
 
@@ -84,12 +90,11 @@ Item * clone_item(enum DefaultItem type) {
  * to names of members of the inventory.
  * @param inventory The inventory to convert
  */
-static const char ** inventory_name_array(List * inventory) {
-	const char ** out = xcalloc(length(inventory) + 1, char *);
+static const char ** inventory_name_array(ListHead * inventory) {
+	const char ** out = xcalloc(list_length(inventory) + 1, char *);
 
 	unsigned int i = 0;
-	for(List * list = inventory; list != NULL; list = list->next) {
-		Item * theitem = fromlist(Item, inventory, list);
+	list_foreach(Item, inventory, theitem, inventory) {
 		out[i] = xcalloc(strlen(theitem->name) + 7 + 1, char);
 		snprintf((char *)out[i], strlen(theitem->name) + 7 + 1,
 		         "%s [x%03i]", theitem->name, theitem->count);
@@ -106,11 +111,11 @@ static const char ** inventory_name_array(List * inventory) {
  * to members of the inventory.
  * @param inventory The inventory to convert
  */
-static const List ** inventory_array(List * inventory) {
-	const List ** out = xcalloc(length(inventory) + 1, List *);
+static const List ** inventory_array(ListHead * inventory) {
+	const List ** out = xcalloc(list_length(inventory) + 1, List *);
 
 	unsigned int i = 0;
-	for(List * list = inventory; list != NULL; list = list->next) {
+	for(List * list = inventory->first; list != NULL; list = list->next) {
 		out[i] = list;
 		i ++;
 	}
@@ -125,7 +130,7 @@ static const List ** inventory_array(List * inventory) {
  * @param inventory The inventory to display
  * @param title The title to display
  */
-void display_inventory(List * inventory, const char * title) {
+void display_inventory(ListHead * inventory, const char * title) {
 	const char ** names = inventory_name_array(inventory);
 	list_choice(true,
 	            title, NULL,
@@ -142,7 +147,7 @@ void display_inventory(List * inventory, const char * title) {
  * @param inventory The inventory to choose from
  * @param prompt The prompt to display
  */
-List ** choose_items(List * inventory, const char * prompt){
+List ** choose_items(ListHead * inventory, const char * prompt){
 	const char ** names = inventory_name_array(inventory);
 	const List ** items = inventory_array(inventory);
 #ifdef AUTOPLAY
@@ -170,16 +175,15 @@ List ** choose_items(List * inventory, const char * prompt){
  * @param no_equipped Don't include equipped things
  * @return NULL if nothing was selected, otherwise a pointer to the choice.
  */
-Item * choose_item_by_type(List * inventory,
+Item * choose_item_by_type(ListHead * inventory,
                            enum ItemType type,
                            const char * prompt,
                            bool no_equipped) {
-	const char ** names = xcalloc(length(inventory) + 1, char *);
-	const void ** items = xcalloc(length(inventory) + 1, void *);
+	const char ** names = xcalloc(list_length(inventory) + 1, char *);
+	const void ** items = xcalloc(list_length(inventory) + 1, void *);
 
 	unsigned int i = 0;
-	for(List * list = inventory; list != NULL; list = list->next) {
-		Item * item = fromlist(Item, inventory, list);
+	list_foreach(Item, inventory, item, inventory) {
 		if(item->type == type &&
 		   ((no_equipped && !item->equipped) || !no_equipped)) {
 			names[i] = item->name;
@@ -52,6 +52,11 @@ enum DefaultItem {
 };
 
 
+/**
+ * The shapes of area a weapon can hit (see area.h).
+ */
+enum AreaKind { AREA_NONE, AREA_BURST, AREA_CONE };
+
 /**
  * Items are things that mobs can carry around, and possibly
  * equip. They live in inventories.
@@ -66,12 +71,16 @@ typedef struct Item {
 	char * name; /**< The name to display when examined */
 
 	bool luminous; /**< Whether the item is luminous or not */
+	bool burns_out; /**< Whether the item, if luminous, goes out in time when dropped */
 	bool can_dig; /**< Whether the item is capable of digging through rock */
 	bool ranged; /**< In the case of a weapon, whether it can be used for ranged combat */
+	enum AreaKind area; /**< In the case of a weapon, the shape of area it hits */
+	unsigned int area_radius; /**< The reach of that area */
 
 	List inventory; /**< The inventory to which this item belongs. */
 
 	bool equipped; /**< Whether the item is equipped or not */
+	unsigned long expires; /**< The turn it rots or goes out, if lying on the floor (see event.h) */
 
 	int value; /**< Some type-dependent value */
 	void (*effect)(struct Mob *); /**< Some type-dependent effect */
@@ -80,9 +89,9 @@ typedef struct Item {
 
 Item * clone_item(enum DefaultItem type);
 
-void display_inventory(List * inventory, const char * title);
-List ** choose_items(List * inventory, const char * prompt);
-Item * choose_item_by_type(List * inventory,
+void display_inventory(ListHead * inventory, const char * title);
+List ** choose_items(ListHead * inventory, const char * prompt);
+Item * choose_item_by_type(ListHead * inventory,
                            enum ItemType type,
                            const char * prompt,
                            bool no_equipped);
@@ -1,5 +1,9 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <assert.h>
 #include <curses.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "level.h"
 #include "mob.h"
@@ -8,10 +12,23 @@
 #include "list.h"
 #include "player.h"
 #include "status.h"
+#include "regions.h"
+#include "connect.h"
+#include "scent.h"
+#include "spatial.h"
+#include "projectile.h"
+#include "hazard.h"
+#include "distmap.h"
+#include "astar.h"
 #include "enemy.h"
+#include "schedule.h"
+#include "batch.h"
 
 extern bool quit;
-extern const struct Mob default_enemies[];
+extern bool parallel_ai;
+extern unsigned long ai_budget;
+extern unsigned long ai_overruns;
+extern const EnemyTemplate default_enemies[];
 
 /**
  * (Shallow) Clone a cell and place it in the given position.
@@ -66,6 +83,7 @@ static void mine_level(Level * level,
                        unsigned int startx, unsigned int starty,
                        Cell * to_place,
                        bool make_stairs) {
+	Rng * gen = level_rng(level, RNG_GEN);
 	unsigned int minersx[num_miners], minersy[num_miners];
 	unsigned int i, m;
 
@@ -77,9 +95,9 @@ static void mine_level(Level * level,
 	/* spread the miners out a little */
 	for(m = 0; m < num_miners; m++) {
 		int dx = (m % 2) ? -1 : 1;
-		unsigned int totalspread = rand() % spread;
+		unsigned int totalspread = rng_below(gen, spread);
 		for(i = 0; i < totalspread; i++) {
-			int dy = (rand() % 2) ? -1 : 1;
+			int dy = rng_below(gen, 2) ? -1 : 1;
 			minersx[m] += dx;
 			minersy[m] += dy;
 
@@ -106,8 +124,8 @@ static void mine_level(Level * level,
 	for(i = 0; i < iterations; i++) {
 		for(m = 0; m < num_miners; m++) {
 			/* pick a random direction */
-			int dx = (rand() % 2) ? -1 : 1;
-			int dy = (rand() % 2) ? -1 : 1;
+			int dx = rng_below(gen, 2) ? -1 : 1;
+			int dy = rng_below(gen, 2) ? -1 : 1;
 			minersx[m] += dx;
 			minersy[m] += dy;
 
@@ -133,7 +151,7 @@ static void mine_level(Level * level,
 
 	/* drop the downstair at the position of a random miner */
 	if (make_stairs) {
-		int m = rand() % num_miners;
+		int m = rng_below(gen, num_miners);
 		level->cells[minersx[m]][minersy[m]]->baseSymbol = '>';
 		level->cells[minersx[m]][minersy[m]]->solid = false;
 		level->endx = minersx[m];
@@ -142,41 +160,84 @@ static void mine_level(Level * level,
 }
 
 /**
- * Add a mob to a level at the specified location.
+ * Place a (registered) mob in a level at the specified location.
  * @param level The level to add to.
  * @param mob The mob to add.
  * @param x The x coordinate to add the mob at.
  * @param y The y coordinate to add the mob at.
  */
 static void add_mob(Level * level, Mob * mob, int x, int y) {
-	mob->level = level;
-	mob->xpos = x;
-	mob->ypos = y;
-	level->mobs = insert(level->mobs, &mob->moblist);
-	level->cells[x][y]->occupant = mob;
+	assert(mob->level == level);
+
+	mob_xpos(mob) = x;
+	mob_ypos(mob) = y;
+	level->cells[x][y]->occupant = mob->id;
+	spatial_add(level, mob->id, x, y);
 }
 
 /**
- * Add a mob to a level at a random location.
+ * Create an enemy and add it to a level at a random location.
  * @param level The level to add to.
- * @param mob The mob to add.
+ * @param mobtype The type of enemy to create.
+ * @return The enemy, or NULL if there was no room for it.
  */
-static void add_mob_random(Level * level, Mob * mob) {
+static Mob * add_enemy_random(Level * level, enum EnemyType mobtype) {
 	/* Try 20 times to get a random clear tile. */
 	int x, y;
 	bool found = false;
 	for (int i = 0; i < 20; i++) {
-		x = rand() % (LEVELWIDTH - 1);
-		y = rand() % (LEVELHEIGHT - 1);
+		x = rng_below(level_rng(level, RNG_GEN), LEVELWIDTH - 1);
+		y = rng_below(level_rng(level, RNG_GEN), LEVELHEIGHT - 1);
 
-		if (!level->cells[x][y]->solid && level->cells[x][y]->occupant == NULL) {
+		if (!level->cells[x][y]->solid && level->cells[x][y]->occupant == NO_MOB &&
+		    reachable(level, x, y, level->startx, level->starty)) {
 			found = true;
 			break;
 		}
 	}
-	if (!found) return;
+	if (!found) return NULL;
 
+	Mob * mob = create_enemy(level, mobtype);
 	add_mob(level, mob, x, y);
+	return mob;
+}
+
+/**
+ * Add an enemy suited to the depth of a level at a random
+ * location. Hunters turn up in packs, as big as their template says,
+ * sharing what they know.
+ * @param level The level to add to.
+ */
+void spawn_enemy(Level * level) {
+	unsigned int available_mobs;
+	for(available_mobs = 0;
+	    default_enemies[available_mobs].mob.min_depth <= level->depth &&
+		    available_mobs < NUM_ENEMY_TYPES;
+	    available_mobs ++);
+
+	enum EnemyType mobtype = (enum EnemyType) biased_rand(level_rng(level, RNG_GEN), available_mobs);
+	Mob * mob = add_enemy_random(level, mobtype);
+	if(mob == NULL) {
+		return;
+	}
+
+	if(default_enemies[mobtype].ai != AI_HUNTER) {
+		return;
+	}
+
+	/* The rest of the pack shares the first's state; a pack of one
+	   (a chaser) just has a memory of the player */
+	HunterState * state = xalloc(HunterState);
+	state->refcount = 1;
+	mob->data = state;
+
+	for(unsigned int i = 1; i < default_enemies[mobtype].pack; i++) {
+		Mob * other = add_enemy_random(level, mobtype);
+		if(other != NULL) {
+			state->refcount ++;
+			other->data = state;
+		}
+	}
 }
 
 /**
@@ -193,14 +254,52 @@ static void place_randomly(Level * level, enum DefaultItem item, unsigned int co
 		int x, y;
 
 		do {
-			x = 1 + (rand() % (LEVELWIDTH-2));
-			y = 1 + (rand() % (LEVELHEIGHT-2));
+			x = 1 + rng_below(level_rng(level, RNG_GEN), LEVELWIDTH-2);
+			y = 1 + rng_below(level_rng(level, RNG_GEN), LEVELHEIGHT-2);
 		} while (level->cells[x][y]->baseSymbol == '<' || level->cells[x][y]->baseSymbol == '>');
 
-		level->cells[x][y]->items = insert(level->cells[x][y]->items, &to_place->inventory);
+		list_insert(&level->cells[x][y]->items, &to_place->inventory);
 	}
 }
 
+/**
+ * Dig a tunnel between the stairs of a level, along the cheapest path
+ * through the rock, for when mining left them apart.
+ * @param level The level, already labelled
+ */
+static void join_stairs(Level * level) {
+	PathOptions options = {.diagonal = true, .cost = &path_dig_cost};
+	unsigned int length = find_path(level_path_finder(level), level,
+	                                level->startx, level->starty,
+	                                level->endx, level->endy,
+	                                &options, NULL, 0);
+	assert(length != PATH_NONE);
+
+	PathStep * steps = xcalloc(length, PathStep);
+	find_path(level_path_finder(level), level,
+	          level->startx, level->starty,
+	          level->endx, level->endy,
+	          &options, steps, length);
+
+	int x = level->startx;
+	int y = level->starty;
+	for(unsigned int i = 0; i < length; i++) {
+		x += steps[i].dx;
+		y += steps[i].dy;
+
+		Cell * cell = level->cells[x][y];
+		if(cell->solid) {
+			cell->baseSymbol = '.';
+			cell->colour = COLOR_WHITE;
+			cell->luminosity = 0;
+			cell->solid = false;
+			connect_dug(level, x, y);
+		}
+	}
+
+	xfree(steps);
+}
+
 /**
  * Initialises a level.
  * @param level Level to initialise.
@@ -217,6 +316,15 @@ void build_level(Level * level) {
 	const int LAKESPREAD = 100;
 	const int LAKEITERATIONS = 5;
 
+	pthread_mutex_init(&level->lock, NULL);
+
+	/* Everything random about the level follows from the game seed
+	   and its depth */
+	for(unsigned int stream = 0; stream < NUM_LEVEL_STREAMS; stream++) {
+		rng_stream(level_rng(level, stream), stream, level->depth);
+	}
+	Rng * gen = level_rng(level, RNG_GEN);
+
 	for(unsigned int y = 0; y < LEVELHEIGHT; y++) {
 		for(unsigned int x = 0; x < LEVELWIDTH; x++) {
 			level->cells[x][y] = xalloc(Cell);
@@ -228,14 +336,14 @@ void build_level(Level * level) {
 				level->cells[x][y]->solid = true;
 			} else {
 				/*fill 99% of the level with rocks*/
-				if (rand() % 100 == 0) {
+				if (rng_below(gen, 100) == 0) {
 					level->cells[x][y]->baseSymbol = '.';
 					level->cells[x][y]->solid = false;
 				} else {
 					level->cells[x][y]->baseSymbol = '#';
 					level->cells[x][y]->solid = true;
 
-					if(rand() % 200 == 0) {
+					if(rng_below(gen, 200) == 0) {
 						level->cells[x][y]->colour = COLOR_YELLOW;
 						level->cells[x][y]->luminosity = 1;
 					}
@@ -245,8 +353,8 @@ void build_level(Level * level) {
 	}
 
 	/* generate starting coordinates near the middle */
-	level->startx = 39 + (rand() % 20);
-	level->starty = 4  + (rand() % 10);
+	level->startx = 39 + rng_below(gen, 20);
+	level->starty = 4  + rng_below(gen, 10);
 
 	/* Mine out passageways */
 	Cell floor = {
@@ -255,8 +363,8 @@ void build_level(Level * level) {
 		.solid = false,
 		.illuminated = false,
 		.luminosity = 0,
-		.occupant = NULL,
-		.items = NULL};
+		.occupant = NO_MOB,
+		.items = {NULL, NULL, 0}};
 
 	mine_level(level,
 	           NMINERS, SPREAD, ITERATIONS,
@@ -270,13 +378,13 @@ void build_level(Level * level) {
 		.solid = false,
 		.illuminated = false,
 		.luminosity = 0,
-		.occupant = NULL,
-		.items = NULL};
+		.occupant = NO_MOB,
+		.items = {NULL, NULL, 0}};
 
-	int lakes = rand() % NUMLAKES;
+	int lakes = rng_below(gen, NUMLAKES);
 	for(int lake = 0; lake < lakes; lake++) {
-		int lx = rand() % LEVELWIDTH;
-		int ly = rand() % LEVELHEIGHT;
+		int lx = rng_below(gen, LEVELWIDTH);
+		int ly = rng_below(gen, LEVELHEIGHT);
 
 		mine_level(level,
 		           NLAKEMINERS, LAKESPREAD, LAKEITERATIONS,
@@ -289,39 +397,18 @@ void build_level(Level * level) {
 	level->cells[level->startx][level->starty]->solid = false;
 	level->cells[level->startx][level->starty]->colour = COLOR_WHITE;
 
-	/* Arbitrary number of mobs */
-	unsigned int available_mobs;
-	for(available_mobs = 0;
-	    default_enemies[available_mobs].min_depth <= level->depth &&
-		    available_mobs < NUM_ENEMY_TYPES;
-	    available_mobs ++);
+	label_level(level);
+	if(!reachable(level, level->startx, level->starty, level->endx, level->endy)) {
+		join_stairs(level);
+	}
+	build_regions(level);
 
+	/* Arbitrary number of mobs, with more turning up later */
 	for (int i = 0; i < 5; i++) {
-		enum EnemyType mobtype = (enum EnemyType) biased_rand(available_mobs);
-		Mob * mob = create_enemy(mobtype);
-
-		add_mob_random(level, mob);
-
-		/* 1. share hunter state
-		   2. hunters always appear in 2s, (giving up to 10 enemies!) */
-		if(mobtype == WOLFMAN  || mobtype == CAVE_PIRATE/* || mobtype == ... */) {
-			Mob * mob2 = create_enemy(mobtype);
-			add_mob_random(level, mob2);
-
-			HunterState * state = xalloc(HunterState);
-			state->refcount += 2;
-			mob->data = state;
-			mob2->data = state;
-		}
-
-		/* chasers are like hunters, but they don't share the state - so
-		 * it's just a memory of the player. */
-		if(mobtype == FALLEN_ANGEL /* || mobtype == ... */) {
-			HunterState * state = xalloc(HunterState);
-			state->refcount = 1;
-			mob->data = state;
-		}
+		spawn_enemy(level);
 	}
+	queue_event(level, SPAWN_MIN_TURNS + rng_below(gen, SPAWN_MAX_TURNS - SPAWN_MIN_TURNS + 1),
+	            EVENT_SPAWN, 0, 0);
 
 	/* add 5 gold for the player to find */
 	place_randomly(level, GOLD, 5);
@@ -329,7 +416,7 @@ void build_level(Level * level) {
 	/* add a regular item for the player to find */
 	{
 		enum DefaultItem item = NO_SUCH_ITEM;
-		switch (rand() % 10) {
+		switch (rng_below(gen, 10)) {
 			case 0: case 1: case 2: case 3: case 4:
 				item = FOOD_RATION;
 				break;
@@ -347,7 +434,7 @@ void build_level(Level * level) {
 	{
 		enum DefaultItem item = NO_SUCH_ITEM;
 
-		switch (rand() % 10) {
+		switch (rng_below(gen, 10)) {
 		case 0: case 1: case 2:
 			item = PICKAXE;
 			break;
@@ -361,7 +448,7 @@ void build_level(Level * level) {
 			item = HELMET;
 			break;
 		case 9:
-			switch (rand() % 13) {
+			switch (rng_below(gen, 13)) {
 			case 0: case 1: case 2: case 3: case 4:
 				if (level->depth > 5) {
 					item = SWORD;
@@ -399,57 +486,248 @@ void build_level(Level * level) {
 }
 
 /**
- * Run afflicated routines on a mob.
- * @param mob Afflicted mob.
+ * Free a level, and everything in it.
+ * @param level The level
  */
-void do_affliction(Mob * mob) {
-	if(!is_afflicted(mob)) return;
-
-	if(mob->effect_duration == 0) {
-		if(mob == mob->level->player) {
-			status_push("The effect wears off.");
+void free_level(Level * level) {
+	while (level->mobtable.count > 0) {
+		kill_mob(level->mobtable.mob[level->mobtable.count - 1]);
+	}
+	mobtable_free(&level->mobtable);
+	heap_free(&level->schedule);
+	xfree(level->dying);
+	free_events(&level->events);
+	free_distance_maps(level);
+	free_regions(level);
+	free_connectivity(level);
+	free_scent(level);
+	free_spatial(level);
+	free_projectiles(level);
+	free_hazards(level);
+	xfree(level->pathfinder);
+	pthread_mutex_destroy(&level->lock);
+
+	for (int x = 0; x < LEVELWIDTH; x++) {
+		for (int y = 0; y < LEVELHEIGHT; y++) {
+			list_foreach_safe(Item, inventory, tmp, next, &level->cells[x][y]->items) {
+				xfree(tmp);
+			}
+			xfree(level->cells[x][y]);
 		}
+		xfree(level->cells[x]);
+	}
+	xfree(level->cells);
+	xfree(level);
+}
 
-		mob->effect_action = NULL;
-		return;
-	} else if(mob->effect_duration > 0) {
-		mob->effect_duration --;
+/**
+ * Have a mob take its turn, according to its AI.
+ * @param mob The mob.
+ * @param ai The AI of the mob.
+ */
+static void do_turn(Mob * mob, enum MobAI ai) {
+	switch(ai) {
+	case AI_PLAYER:
+		player_turn(mob);
+		break;
+	case AI_SIMPLE:
+	case AI_HUNTER:
+		enemy_turn(mob);
+		break;
+	case AI_NONE:
+		break;
 	}
+}
 
-	mob->effect_action(mob);
+/**
+ * Queue a mob which has just died, to be freed at the end of the turn.
+ * @param level The level the mob is in
+ * @param id The mob
+ */
+void queue_death(Level * level, MobId id) {
+	if(level->num_dying == level->dying_capacity) {
+		level->dying_capacity = (level->dying_capacity == 0) ? 8 : level->dying_capacity * 2;
+		level->dying = xrealloc(level->dying, level->dying_capacity, MobId);
+	}
+
+	level->dying[level->num_dying++] = id;
 }
 
 /**
- * A "turn" consists of all of the mobs acting once, possibly followed
- * by some constant effect on the mob. As the player is a turn, this
- * is (indirectly) where blocking for input happens.
+ * Free the mobs which have died this turn.
+ * @param level The level
+ */
+static void reap_dead(Level * level) {
+	for(unsigned int i = 0; i < level->num_dying; i++) {
+		Mob * mob = mobtable_get(&level->mobtable, level->dying[i]);
+
+		/* It may have been healed since, or queued twice */
+		if(mob != NULL && mob_health(mob) <= 0) {
+			kill_mob(mob);
+		}
+	}
+
+	level->num_dying = 0;
+}
+
+/** The time enemies have spent thinking this turn, in microseconds. */
+static unsigned long ai_spent;
+
+/**
+ * The time on a monotonic clock, in microseconds. This is wall time
+ * rather than CPU time, as a batch thinks on several threads at once
+ * and the budget is for how long the turn takes.
+ */
+static unsigned long long now_us(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/**
+ * Check if enemies have used up their thinking time for the turn.
+ */
+static bool over_budget(void) {
+	return ai_budget != 0 && ai_spent >= ai_budget;
+}
+
+/**
+ * Take a turn, counting the time enemies spend against the budget, and
+ * letting them idle if it's used up.
+ * @param mob The mob.
+ */
+static void take_turn(Mob * mob) {
+	if(ai_budget == 0 || mob_ai(mob) == AI_PLAYER) {
+		do_turn(mob, mob_ai(mob));
+	} else if(over_budget()) {
+		idle_turn(mob);
+		ai_overruns ++;
+	} else {
+		unsigned long long start = now_us();
+		do_turn(mob, mob_ai(mob));
+		ai_spent += now_us() - start;
+	}
+}
+
+/**
+ * A "turn" is TURN_TICKS of the level clock, in which every mob
+ * whose energy allows acts (fast mobs may act several times, slow
+ * ones not at all), followed by some constant effect on the
+ * mobs. Mobs are taken from the schedule in the order they are due,
+ * so mobs with nothing to do cost nothing. As the player is a turn,
+ * this is (indirectly) where blocking for input happens. With
+ * parallel_ai set, the enemies due at each tick decide together and
+ * then act in turn (see batch.c). With ai_budget set, enemies which
+ * come up once the turn's thinking time is used up just wander.
  * @param level The level grid to run the turn on.
  */
 void run_turn(Level * level) {
-	/* Process each mob's turn */
-	for(List * moblist = level->mobs; moblist != NULL && !quit; moblist = moblist->next) {
-		Mob * mob = fromlist(Mob, moblist, moblist);
-		if(mob->health <= 0) {
+	unsigned long end = level->time + TURN_TICKS;
+
+	ai_spent = 0;
+
+	/* Anything asleep near the player joins in */
+	wake_nearby(level);
+
+	/* Process each mob's actions. If the player leaves, the rest of
+	   the level waits for them. */
+	Mob * mob = NULL;
+	while(!quit && level->player != NULL &&
+	      (mob != NULL || (mob = next_actor(level, end)) != NULL)) {
+		if(try_sleep(mob)) {
+			mob = NULL;
 			continue;
 		}
 
-		if(mob->turn_action != NULL) {
-			mob->turn_action(mob);
+		if(!parallel_ai || mob_ai(mob) == AI_PLAYER || over_budget()) {
+			take_turn(mob);
+
+			/* The mob may have changed level, in which case it is
+			   queued in the new one */
+			finish_action(mob);
+			mob = NULL;
+			continue;
 		}
-		do_affliction(mob);
-	}
-
-	/* Free dead mobs */
-	List * moblist = level->mobs;
-	while(moblist != NULL) {
-		Mob * mob = fromlist(Mob, moblist, moblist);
-		if(mob->health <= 0) {
-			Mob * nextmob = kill_mob(mob);
-			moblist = (nextmob == NULL) ? NULL : &nextmob->moblist;
-		} else {
-			moblist = moblist->next;
+
+		/* Gather the enemies due at this tick, up to the player (who
+		   is held over to go next), and run them as a batch. Nothing
+		   they do can make another due at the same tick. */
+		unsigned long now = level->time;
+		batch_add(mob);
+		while((mob = next_actor(level, now + 1)) != NULL &&
+		      mob_ai(mob) != AI_PLAYER) {
+			if(!try_sleep(mob)) {
+				batch_add(mob);
+			}
 		}
+
+		unsigned long long start = now_us();
+		batch_run();
+		ai_spent += now_us() - start;
 	}
+
+	level->time = end;
+
+	/* Anything in flight flies on */
+	run_projectiles(level);
+
+	/* The player's scent spreads, if they're still here */
+	if(level->player != NULL) {
+		spread_scent(level);
+	}
+
+	/* Fire and gas spread */
+	spread_hazards(level);
+
+	/* Anything scheduled for this turn happens */
+	run_events(level);
+
+	/* Apply constant effects */
+	if(!quit) {
+		run_effects(level);
+	}
+
+	reap_dead(level);
+}
+
+/**
+ * Run a coarse turn, standing in for several ordinary ones, on a level
+ * the player isn't on: wanderers wander, hunters lose track of the
+ * player, and effects run their course. This touches nothing outside
+ * the level, so levels can be run like this on other threads (with
+ * the level lock held).
+ * @param level The level to run.
+ * @param turns The number of turns to cover.
+ */
+void run_background_turn(Level * level, unsigned int turns) {
+	MobTable * table = &level->mobtable;
+
+	level->time += turns * TURN_TICKS;
+	run_events(level);
+
+	for(unsigned int row = table->count; row-- > 0; ) {
+		Mob * mob = table->mob[row];
+		if(table->health[row] <= 0) {
+			continue;
+		}
+
+		/* With no player to see, the chase is off */
+		if(table->ai[row] == AI_HUNTER) {
+			((HunterState *) mob->data)->chase = false;
+		}
+
+		/* Dormant mobs catch up when they wake */
+		if(!table->dormant[row] && is_wandering(mob)) {
+			catch_up_wander(mob, moves_in(mob, turns * TURN_TICKS));
+			table->cost[row] = 0;
+		}
+	}
+
+	for(unsigned int t = 0; t < turns; t++) {
+		run_effects(level);
+	}
+
+	reap_dead(level);
 }
 
 /**
@@ -469,7 +747,7 @@ static void calculate_illumination(Level * level) {
 		for(unsigned int y = 0; y < LEVELHEIGHT; y++) {
 			Cell * cell = level->cells[x][y];
 			if(cell->luminosity > 0 ||
-			   (cell->occupant != NULL && cell->occupant->luminosity > 0)) {
+			   (cell->occupant != NO_MOB && get_occupant(level, x, y)->luminosity > 0)) {
 				/* Luminous cells are illuminated */
 				level->cells[x][y]->illuminated = true;
 
@@ -513,15 +791,22 @@ void display_level(Level * level) {
 
 			playerdata->terrain->symbols[x][y] = level->cells[x][y]->baseSymbol;
 
-			if(level->cells[x][y]->occupant != NULL &&
-			   level->cells[x][y]->occupant->health > 0) {
+			Mob * occupant = get_occupant(level, x, y);
+			if(occupant != NULL && mob_health(occupant) > 0) {
 				mvaddchcol(y, x,
-				           level->cells[x][y]->occupant->symbol,
-				           level->cells[x][y]->occupant->colour, COLOR_BLACK,
-				           level->cells[x][y]->occupant->is_bold);
-			} else if(level->cells[x][y]->items != NULL) {
-				Item * item = fromlist(Item, inventory, level->cells[x][y]->items);
+				           occupant->symbol,
+				           occupant->colour, COLOR_BLACK,
+				           occupant->is_bold);
+			} else if(level->cells[x][y]->items.first != NULL) {
+				Item * item = fromlist(Item, inventory, level->cells[x][y]->items.first);
 				mvaddch(y, x, item->symbol);
+			} else if(hazard_at(level, HAZARD_FIRE, x, y) >= HAZARD_HARMFUL) {
+				mvaddchcol(y, x, '^', COLOR_RED, COLOR_BLACK, true);
+			} else if(hazard_at(level, HAZARD_GAS, x, y) >= HAZARD_HARMFUL) {
+				mvaddchcol(y, x,
+				           level->cells[x][y]->baseSymbol,
+				           COLOR_MAGENTA, COLOR_BLACK,
+				           false);
 			} else {
 				mvaddchcol(y, x,
 				           level->cells[x][y]->baseSymbol,
@@ -531,13 +816,23 @@ void display_level(Level * level) {
 		}
 	}
 
+	/* Anything in flight is drawn over what it passes */
+	if(level->projectiles != NULL) {
+		for(unsigned int i = 0; i < level->projectiles->count; i++) {
+			Projectile * projectile = &level->projectiles->projectiles[i];
+			if(can_see(player, projectile->x, projectile->y)) {
+				mvaddch(projectile->y, projectile->x, '*');
+			}
+		}
+	}
+
 	/* Display player stats */
 	mvaddprintf(21, 5, "%s, the %s %s", player->name, player->race, player->profession);
 	mvaddprintf(22, 5, "HP: %d/%d, Atk: %d (+%d), Def: %d (+%d), Con: %d",
-	            player->health, player->max_health,
-	            player->attack, (player->weapon == NULL) ? 0 : player->weapon->value,
-	            player->defense, (player->armour == NULL) ? 0 : player->armour->value,
-	            player->con);
+	            mob_health(player), mob_stats(player)->max_health,
+	            mob_stats(player)->attack, (player->weapon == NULL) ? 0 : player->weapon->value,
+	            mob_stats(player)->defense, (player->armour == NULL) ? 0 : player->armour->value,
+	            mob_stats(player)->con);
 
 	/* Display what level we are on */
 	mvaddprintf(23, 5, "Depth: %d", level->depth);
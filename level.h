@@ -2,10 +2,16 @@
 #define LEVEL_H
 
 #include <stdbool.h>
+#include <pthread.h>
 
 #include "mob.h"
 #include "item.h"
 #include "list.h"
+#include "mobtable.h"
+#include "heap.h"
+#include "timerwheel.h"
+#include "event.h"
+#include "rng.h"
 
 /** The width of a level in characters. */
 #define LEVELWIDTH  80
@@ -26,8 +32,8 @@ typedef struct Cell {
 	bool illuminated; /**< Whether the cell is lit by a light or not. */
 	unsigned int luminosity; /**< Number of light sources in the cell */
 
-	struct Mob * occupant; /**< The occpuant (may be NULL). */
-	struct List * items;   /**< The list of items (may be NULL). */
+	MobId occupant;        /**< The id of the occupant (may be NO_MOB). */
+	ListHead items;        /**< The list of items. */
 } Cell;
 
 /**
@@ -38,19 +44,47 @@ typedef struct Cell {
 typedef struct Level {
 	List levels; /**< The list of levels to which this belongs */
 
-	List * mobs; /**< The list of mobs in the level. */
-	struct Mob * player; /**< The player mob (must also be in mobs). */
+	MobTable mobtable; /**< The mobs in the level. */
+	struct Mob * player; /**< The player mob (must also be in mobtable). */
 
 	unsigned int depth; /**< The depth of the level.*/
 
+	unsigned long time; /**< The level clock, in ticks (see schedule.h). */
+	Heap schedule; /**< When each mob will next act. */
+	ListHead effects; /**< The effects on the mobs in the level, run every turn. */
+	TimerWheel expiries; /**< When each effect wears off, in turns. */
+	EventQueue events; /**< What is to happen in the level, by turn. */
+
+	MobId * dying; /**< The mobs which have died this turn, to be freed. */
+	unsigned int num_dying; /**< The number of mobs in dying. */
+	unsigned int dying_capacity; /**< The size of dying. */
+
+	pthread_mutex_t lock; /**< Held while the level runs in the background, or a mob enters it. */
+
+	unsigned long terrain_epoch; /**< Bumped whenever a cell's solidity changes. */
+	struct DistanceMaps * distmaps; /**< Cached distance maps (see distmap.h), or NULL. */
+	struct RegionGraph * regions; /**< The region graph (see regions.h). */
+	struct Connectivity * connectivity; /**< The connected parts of the level (see connect.h). */
+	struct ScentMap * scent; /**< The player's scent and noise (see scent.h), or NULL. */
+	struct SpatialIndex * spatial; /**< Where the mobs are (see spatial.h), or NULL. */
+	struct ProjectilePool * projectiles; /**< What's in flight (see projectile.h), or NULL. */
+	struct HazardMap * hazards; /**< The fire and gas spreading about (see hazard.h), or NULL. */
+	struct PathFinder * pathfinder; /**< Storage for path searches made in turn, or NULL. */
+
 	int startx, starty; /**< The x and y positions of the stairs from the previous level. */
 	int endx, endy; /**< The x and y positions of the stairs to the next level. */
 
+	Rng rng[NUM_LEVEL_STREAMS]; /**< The level's streams of random numbers (see rng.h). */
+
 	struct Cell * cells[LEVELWIDTH][LEVELHEIGHT]; /**< The map. */
 } Level;
 
 void build_level(Level * level);
+void free_level(Level * level);
 void run_turn(Level * level);
+void run_background_turn(Level * level, unsigned int turns);
+void queue_death(Level * level, MobId id);
+void spawn_enemy(Level * level);
 void display_level(Level * level);
 
 #endif /* LEVEL_H */
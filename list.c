@@ -45,68 +45,112 @@ List * gettail(List * list) {
 }
 
 /**
- * Chop the given item out of the list, updating the prev and
- * next. Returns the head of the list (may not have changed)
- * @param list The list item to remove
+ * Insert an entry at the front of a list.
+ * @param head The list to mutate
+ * @param entry The entry to insert (must not be in any list)
  */
-List * drop(List * list) {
-	assert(list != NULL);
+void list_insert(ListHead * head, List * entry) {
+	assert(head != NULL);
+	assert(entry != NULL);
 
-	List * head = list->next;
+	setnext(entry, head->first);
+	setprev(entry, NULL);
 
-	if(list->prev != NULL) {
-		setnext(list->prev, list->next);
-		head = gethead(list->prev);
+	if(head->first != NULL) {
+		setprev(head->first, entry);
+	} else {
+		head->last = entry;
 	}
-	if(list->next != NULL) {
-		setprev(list->next, list->prev);
+
+	head->first = entry;
+	head->length ++;
+}
+
+/**
+ * Add an entry to the back of a list.
+ * @param head The list to mutate
+ * @param entry The entry to add (must not be in any list)
+ */
+void list_push(ListHead * head, List * entry) {
+	assert(head != NULL);
+	assert(entry != NULL);
+
+	setnext(entry, NULL);
+	setprev(entry, head->last);
+
+	if(head->last != NULL) {
+		setnext(head->last, entry);
+	} else {
+		head->first = entry;
 	}
 
-	return head;
+	head->last = entry;
+	head->length ++;
 }
 
 /**
- * Insert an item to a list. Returns the head.
- * @param list The list to mutate
- * @param insert The list item to insert
+ * Chop the given entry out of a list, updating its neighbours and
+ * the ends of the list.
+ * @param head The list containing the entry
+ * @param entry The entry to remove
  */
-List * insert(List * list, List * insert) {
-	assert(insert != NULL);
+void list_drop(ListHead * head, List * entry) {
+	assert(head != NULL);
+	assert(entry != NULL);
+	assert(head->length > 0);
+
+	if(entry->prev != NULL) {
+		setnext(entry->prev, entry->next);
+	} else {
+		assert(head->first == entry);
+		head->first = entry->next;
+	}
 
-	setnext(insert, list);
-	setprev(insert, NULL);
-	if(list != NULL) {
-		setprev(list, insert);
+	if(entry->next != NULL) {
+		setprev(entry->next, entry->prev);
+	} else {
+		assert(head->last == entry);
+		head->last = entry->prev;
 	}
 
-	return insert;
+	setnext(entry, NULL);
+	setprev(entry, NULL);
+	head->length --;
 }
 
 /**
- * Appends the source list to the target list. Returns the new head.
+ * Move the entire contents of one list onto the back of another. The
+ * source list is left empty.
  * @param target The list to append to
  * @param source The list to append
  */
-List * append(List * target, List * source) {
-	if(target == NULL) {
-		return source;
+void list_splice(ListHead * target, ListHead * source) {
+	assert(target != NULL);
+	assert(source != NULL);
+
+	if(source->first == NULL) {
+		return;
 	}
 
-	List * tail = gettail(target);
-	tail->next = source;
-	source->prev = tail;
+	if(target->last == NULL) {
+		target->first = source->first;
+	} else {
+		setnext(target->last, source->first);
+		setprev(source->first, target->last);
+	}
+
+	target->last = source->last;
+	target->length += source->length;
 
-	return target;
+	source->first = NULL;
+	source->last = NULL;
+	source->length = 0;
 }
 
 /**
- * Get the length of the list
- * @param list The list
+ * Get the length of a list
+ * @param head The list
  */
-unsigned int length(List * list) {
-	unsigned int out = 0;
-	for(List * item = list; item != NULL; item = item->next) {
-		out ++;
-	}
-	return out;
+unsigned int list_length(const ListHead * head) {
+	return head->length;
 }
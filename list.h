@@ -9,6 +9,17 @@ typedef struct List {
 	struct List * prev;
 } List;
 
+/**
+ * A doubly-linked list which knows its ends and its length, so that
+ * insertion, removal, splicing, and counting are all constant
+ * time. A zeroed ListHead is a valid empty list.
+ */
+typedef struct ListHead {
+	List * first; /**< The first entry (NULL if empty) */
+	List * last;  /**< The last entry (NULL if empty) */
+	unsigned int length; /**< The number of entries */
+} ListHead;
+
 #ifndef offsetof
 	#define offsetof(st, m) __builtin_offsetof(st, m)
 #endif
@@ -19,13 +30,40 @@ typedef struct List {
  */
 #define fromlist(T,LF,LP) ((T*) ((char*)(LP) - offsetof(T, LF)))
 
+/**
+ * Like fromlist, but maps a NULL list pointer to a NULL structure
+ * pointer, whatever the offset of the list field.
+ */
+#define list_entry(T,LF,LP) (((LP) == NULL) ? NULL : fromlist(T, LF, LP))
+
+/**
+ * Iterate over the structures in a ListHead.
+ * T - type, LF - list field name, VAR - loop variable, LH - list head
+ */
+#define list_foreach(T,LF,VAR,LH) \
+	for(T * VAR = list_entry(T, LF, (LH)->first); \
+	    VAR != NULL; \
+	    VAR = list_entry(T, LF, VAR->LF.next))
+
+/**
+ * Iterate over the structures in a ListHead, where the loop body may
+ * remove (or free) the current entry. NEXT is the lookahead variable.
+ */
+#define list_foreach_safe(T,LF,VAR,NEXT,LH) \
+	for(T * VAR = list_entry(T, LF, (LH)->first), \
+	      * NEXT = (VAR == NULL) ? NULL : list_entry(T, LF, VAR->LF.next); \
+	    VAR != NULL; \
+	    VAR = NEXT, NEXT = (VAR == NULL) ? NULL : list_entry(T, LF, VAR->LF.next))
+
 void setnext(List * list, List * next);
 void setprev(List * list, List * prev);
 List * gethead(List * list);
 List * gettail(List * list);
-List * drop(List * list);
-List * insert(List * list, List * insert);
-List * append(List * target, List * source);
-unsigned int length(List * list);
+
+void list_insert(ListHead * head, List * entry);
+void list_push(ListHead * head, List * entry);
+void list_drop(ListHead * head, List * entry);
+void list_splice(ListHead * target, ListHead * source);
+unsigned int list_length(const ListHead * head);
 
 #endif
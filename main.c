@@ -3,6 +3,8 @@
 #include <stdlib.h>
 #include <time.h>
 #include <signal.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "utils.h"
 #include "level.h"
@@ -10,10 +12,34 @@
 #include "item.h"
 #include "player.h"
 #include "list.h"
+#include "background.h"
+#include "realtime.h"
+#include "spatial.h"
+#include "pregen.h"
 
 /** Whether to quit the game or not. */
 bool quit = false;
 
+/** Whether to keep recently visited levels running in the background. */
+bool background_levels = false;
+
+/** Whether enemies decide their turns in parallel. */
+bool parallel_ai = false;
+
+/** Whether the world runs on a clock, rather than waiting for the player. */
+bool realtime = false;
+
+/** The wall-clock time, in microseconds, enemies may think for each turn
+ * (0 for no limit). A batch decided on several threads counts once, for
+ * how long it takes, and background levels don't count at all. */
+unsigned long ai_budget = 0;
+
+/** The number of enemy turns taken without thinking, for want of time. */
+unsigned long ai_overruns = 0;
+
+/** The seed everything random in the game follows from (see rng.h). */
+unsigned long game_seed = 0;
+
 /**
  * Catch a sigint and exit gracefully
  */
@@ -23,8 +49,56 @@ void catch_sigint(int dummy) {
     quit = true;
 }
 
+/**
+ * Parse the command line, setting the options.
+ * @param argc The number of arguments
+ * @param argv The arguments
+ * @return false if the command line is bad
+ */
+static bool parse_args(int argc, char ** argv) {
+	bool seeded = false;
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "--background") == 0) {
+			background_levels = true;
+		} else if(strcmp(argv[i], "--parallel-ai") == 0) {
+			parallel_ai = true;
+		} else if(strcmp(argv[i], "--realtime") == 0) {
+			realtime = true;
+		} else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			char * end;
+			game_seed = strtoul(argv[++i], &end, 10);
+			if(*end != '\0') {
+				fprintf(stderr, "%s: bad seed '%s'\n", argv[0], argv[i]);
+				return false;
+			}
+			seeded = true;
+		} else if(strcmp(argv[i], "--ai-budget") == 0 && i + 1 < argc) {
+			char * end;
+			ai_budget = strtoul(argv[++i], &end, 10);
+			if(*end != '\0') {
+				fprintf(stderr, "%s: bad budget '%s'\n", argv[0], argv[i]);
+				return false;
+			}
+		} else {
+			fprintf(stderr, "Usage: %s [--background] [--parallel-ai] [--realtime] [--ai-budget MICROSECONDS] [--seed SEED]\n", argv[0]);
+			return false;
+		}
+	}
+
+	if(!seeded) {
+		game_seed = (unsigned long) time(NULL);
+	}
+
+	return true;
+}
+
 /** Entry point. */
-int main() {
+int main(int argc, char ** argv) {
+	if(!parse_args(argc, argv)) {
+		return 1;
+	}
+
 	/* Initialise curses */
 	WINDOW * mainwin = initscr();
 	start_color();
@@ -41,21 +115,18 @@ int main() {
 	/* Attach the signal handler */
 	signal(SIGINT, catch_sigint);
 
-	srand(time(NULL));
-
-	Mob * player = create_player();
-
 	Level * level_head = xalloc(Level);
-	level_head->mobs = &player->moblist;
-	level_head->player = player;
 
-	player->level = level_head;
+	Mob * player = create_player(level_head);
+	level_head->player = player;
 
 	build_level(level_head);
 
-	player->xpos = level_head->startx;
-	player->ypos = level_head->starty;
-	level_head->cells[player->xpos][player->ypos]->occupant = player;
+	mob_xpos(player) = level_head->startx;
+	mob_ypos(player) = level_head->starty;
+	level_head->cells[mob_xpos(player)][mob_ypos(player)]->occupant = player->id;
+	spatial_add(level_head, player->id, mob_xpos(player), mob_ypos(player));
+	pregenerate(level_head);
 
 #ifndef AUTOPLAY
 	/* Intro text */
@@ -72,36 +143,44 @@ int main() {
 
 	/* Game loop */
 	while(!quit) {
-		/* Update mobs */
+		if(realtime) {
+			realtime_tick_start();
+		}
+
+		/* Update mobs, with the recent levels alongside if wanted */
+		if(background_levels) {
+			background_visit(player->level);
+			background_start();
+		}
+
 		run_turn(player->level);
 
-		clear();
+		if(background_levels) {
+			background_finish();
+		}
+
+		/* In real time the player isn't due every tick, so redraw the
+		 * level here rather than clearing the screen and leaving it blank
+		 * until the player's turn draws it. Erasing only blanks the
+		 * window, so the refresh in display_level doesn't flicker. */
+		if(realtime) {
+			if(!quit) {
+				erase();
+				display_level(player->level);
+			}
+			realtime_tick_end();
+		} else {
+			clear();
+		}
 	}
 
 	/* Free the things */
+	pregenerate_finish();
 	while (level_head != NULL) {
 		Level * level = level_head;
 		level_head = (level_head->levels.next == NULL) ? NULL : fromlist(Level, levels, level_head->levels.next);
 
-		Mob * mob = fromlist(Mob, moblist, level->mobs);
-		while (mob != NULL) {
-			mob = kill_mob(mob);
-		}
-
-		for (int x = 0; x < LEVELWIDTH; x++) {
-			for (int y = 0; y < LEVELHEIGHT; y++) {
-				List * inventory = level->cells[x][y]->items;
-				while (inventory != NULL) {
-					Item * tmp = fromlist(Item, inventory, inventory);
-					inventory = inventory->next;
-					xfree(tmp);
-				}
-				xfree(level->cells[x][y]);
-			}
-			xfree(level->cells[x]);
-		}
-		xfree(level->cells);
-		xfree(level);
+		free_level(level);
 	}
 
 	/* Deinitialise curses */
@@ -111,4 +190,12 @@ int main() {
 	nocbreak();
 	delwin(mainwin);
 	endwin();
+
+	if(realtime) {
+		realtime_report();
+	}
+
+	if(ai_budget != 0) {
+		printf("Enemies ran out of thinking time %lu times.\n", ai_overruns);
+	}
 }
@@ -11,6 +11,39 @@
 #include "player.h"
 #include "status.h"
 #include "enemy.h"
+#include "schedule.h"
+#include "regions.h"
+#include "connect.h"
+#include "spatial.h"
+#include "area.h"
+#include "hazard.h"
+#include "pregen.h"
+#include "projectile.h"
+#include "scent.h"
+
+/**
+ * Add a mob to the MobTable of a level, and queue it to act. The mob
+ * has no position until it is placed in a cell, and all of its
+ * components start zeroed.
+ * @param level The level the mob belongs to.
+ * @param mob The mob to register.
+ */
+void register_mob(Level * level, Mob * mob) {
+	mob->level = level;
+	mobtable_add(&level->mobtable, mob);
+	schedule_mob(mob);
+}
+
+/**
+ * Find the mob occupying a cell.
+ * @param level The level to look in.
+ * @param x The X coordinate.
+ * @param y The Y coordinate.
+ * @return The occupant, or NULL if the cell is empty.
+ */
+Mob * get_occupant(Level * level, unsigned int x, unsigned int y) {
+	return mobtable_get(&level->mobtable, level->cells[x][y]->occupant);
+}
 
 /**
  * Move the given mob to the new coordinates.
@@ -21,7 +54,7 @@
  */
 bool move_mob(Mob * mob, unsigned int x, unsigned int y) {
 	Level * level = mob->level;
-	Cell * source = level->cells[mob->xpos][mob->ypos];
+	Cell * source = level->cells[mob_xpos(mob)][mob_ypos(mob)];
 	Cell * target = level->cells[x][y];
 
 	if(source == target)
@@ -29,10 +62,11 @@ bool move_mob(Mob * mob, unsigned int x, unsigned int y) {
 
 	/* allow for digging through rock */
 	if (mob->weapon != NULL && mob->weapon->can_dig == true &&
-		target->occupant == NULL &&
+		target->occupant == NO_MOB &&
 		target->solid == true &&
 	    target->baseSymbol == '#') {
-		if((rand() % mob->weapon->value) < 2) {
+		charge_action(mob, ACTION_DIG);
+		if(rng_below(level_rng(level, RNG_COMBAT), mob->weapon->value) < 2) {
 			if(mob == mob->level->player) {
 				status_push("Your %s bounces off the rock.",
 				            mob->weapon->name);
@@ -43,36 +77,50 @@ bool move_mob(Mob * mob, unsigned int x, unsigned int y) {
 				            mob->weapon->name);
 			}
 			target->solid = false;
+			level->terrain_epoch ++;
+			regions_dug(level, x, y);
+			connect_dug(level, x, y);
 			target->baseSymbol = '.';
 			target->colour = COLOR_WHITE;
 			target->luminosity = 0;
 		}
 	}
 
-	if(target->solid == true || target->occupant != NULL) {
+	if(target->solid == true || target->occupant != NO_MOB) {
 		return false;
 	}
 
-	source->occupant = NULL;
-	target->occupant = mob;
-	mob->xpos = x;
-	mob->ypos = y;
+	source->occupant = NO_MOB;
+	target->occupant = mob->id;
+	spatial_move(level, mob->id, mob_xpos(mob), mob_ypos(mob), x, y);
+	mob_xpos(mob) = x;
+	mob_ypos(mob) = y;
+	charge_action(mob, ACTION_MOVE);
 
-	/* Check for poison water - this should not be in move, but it
-	   works for now. */
-	if(target->baseSymbol == '~' && mob->effect_action != &effect_poison) {
+	/* Check for poison water and gas - this should not be in move,
+	   but it works for now. */
+	if((target->baseSymbol == '~' || hazard_at(level, HAZARD_GAS, x, y) >= HAZARD_HARMFUL) &&
+	   !has_effect(mob, &effect_poison)) {
 		if(mob == mob->level->player) {
 			status_push("You have been poisoned!");
 		}
 
 		int duration = 5;
-		if(mob->con != 0) {
-			duration -= rand() % mob->con;
+		if(mob_stats(mob)->con != 0) {
+			duration -= (int) rng_below(level_rng(level, RNG_COMBAT), mob_stats(mob)->con);
 		}
 		duration = (duration < 1) ? 1 : duration;
 		afflict(mob, &effect_poison, duration);
 	}
 
+	if(hazard_at(level, HAZARD_FIRE, x, y) >= HAZARD_HARMFUL && !has_effect(mob, &effect_burn)) {
+		if(mob == mob->level->player) {
+			status_push("You step into the flames!");
+		}
+
+		afflict(mob, &effect_burn, 3);
+	}
+
 	return true;
 }
 
@@ -84,24 +132,27 @@ bool move_mob(Mob * mob, unsigned int x, unsigned int y) {
  * @return If the mob was moved successfully.
  */
 bool move_mob_relative(Mob * mob, int xdiff, int ydiff) {
-	return move_mob(mob, mob->xpos + xdiff, mob->ypos + ydiff);
+	return move_mob(mob, mob_xpos(mob) + xdiff, mob_ypos(mob) + ydiff);
 }
 
 /**
- * Attack a mob, modified by the weapon of the attacker and the armour
- * of the defender.
- * @param attacker The mob doing the attacking.
+ * Roll the damage of a blow, modified by the weapon it is struck with
+ * and the armour of the defender.
+ * @param rng The generator to draw from.
+ * @param attack The attack behind the blow.
+ * @param weapon The weapon (may be NULL).
  * @param defender The mob being attacked.
+ * @return The damage, which is always at least 1.
  */
-void attack_mob(Mob * attacker, Mob * defender) {
-	int damage = attacker->attack - defender->defense;
+int roll_blow(Rng * rng, int attack, const Item * weapon, Mob * defender) {
+	int damage = attack - mob_stats(defender)->defense;
 
-	if(attacker->weapon != NULL) {
-		damage += 1 + rand() % attacker->weapon->value;
+	if(weapon != NULL) {
+		damage += 1 + (int) rng_below(rng, weapon->value);
 	}
 
 	if(defender->armour != NULL) {
-		damage -= 1 + rand() % defender->armour->value;
+		damage -= 1 + (int) rng_below(rng, defender->armour->value);
 	}
 
 	/* Can always do at least 1 damage */
@@ -109,36 +160,36 @@ void attack_mob(Mob * attacker, Mob * defender) {
 		damage = 1;
 	}
 
-	/* Update the status */
-	if(attacker == attacker->level->player) {
-		const char * messages[] = {
-			"You attack the %s for %d damage.",
-			"You attack the %s for %d damage.",
-			"You attack the %s for %d damage.",
-			"You hit the %s for %d damage.",
-			"You hit the %s for %d damage.",
-			"You cleave the %s in twain for %d damage.",
-			NULL
-		};
-
-		status_push((const char *)random_choice((const void **)messages),
-		            defender->name,
-		            damage);
-	} else {
-		status_push("The %s attacks you for %d damage!",
-		            attacker->name,
-		            damage);
-	}
+	return damage;
+}
 
-	/* Damage the defender */
-	damage_mob(defender, (unsigned int) damage);
+/**
+ * Roll the damage of an attack, modified by the weapon of the attacker
+ * and the armour of the defender.
+ * @param attacker The mob doing the attacking.
+ * @param defender The mob being attacked.
+ * @return The damage, which is always at least 1.
+ */
+int roll_damage(Mob * attacker, Mob * defender) {
+	return roll_blow(level_rng(attacker->level, RNG_COMBAT),
+	                 mob_stats(attacker)->attack, attacker->weapon, defender);
+}
 
-	/* Call weapon/armour effects */
-	if(attacker->weapon != NULL &&
-	   attacker->weapon->fight_effect != NULL) {
-		attacker->weapon->fight_effect(attacker, attacker->weapon,
-		                               attacker, defender,
-		                               damage);
+/**
+ * Call the effects of the weapons and armour of both sides of a fight,
+ * once the damage has been done.
+ * @param attacker The mob doing the attacking.
+ * @param weapon What the attacker struck with: their weapon, or
+ * something they threw (may be NULL).
+ * @param defender The mob being attacked.
+ * @param damage The damage done to the defender.
+ */
+void fight_effects(Mob * attacker, Item * weapon, Mob * defender, int damage) {
+	if(weapon != NULL &&
+	   weapon->fight_effect != NULL) {
+		weapon->fight_effect(attacker, weapon,
+		                     attacker, defender,
+		                     damage);
 	}
 
 	if(attacker->offhand != NULL &&
@@ -163,6 +214,98 @@ void attack_mob(Mob * attacker, Mob * defender) {
 	}
 }
 
+/**
+ * Which factions fight which, by the faction of the one deciding and
+ * the faction of the other. Feuds go both ways.
+ */
+static const bool hostilities[NUM_FACTIONS][NUM_FACTIONS] = {
+	[FACTION_PLAYER] = {
+		[FACTION_BEASTS] = true, [FACTION_ORCS] = true,
+		[FACTION_PIRATES] = true, [FACTION_MONSTERS] = true,
+		[FACTION_DRAGONS] = true
+	},
+	[FACTION_BEASTS] = {
+		[FACTION_PLAYER] = true, [FACTION_MONSTERS] = true,
+		[FACTION_DRAGONS] = true
+	},
+	[FACTION_ORCS] = {
+		[FACTION_PLAYER] = true, [FACTION_PIRATES] = true,
+		[FACTION_DRAGONS] = true
+	},
+	[FACTION_PIRATES] = {
+		[FACTION_PLAYER] = true, [FACTION_ORCS] = true,
+		[FACTION_DRAGONS] = true
+	},
+	[FACTION_MONSTERS] = {
+		[FACTION_PLAYER] = true, [FACTION_BEASTS] = true,
+		[FACTION_DRAGONS] = true
+	},
+	[FACTION_DRAGONS] = {
+		[FACTION_PLAYER] = true, [FACTION_BEASTS] = true,
+		[FACTION_ORCS] = true, [FACTION_PIRATES] = true,
+		[FACTION_MONSTERS] = true
+	}
+};
+
+/**
+ * Check if a mob would fight another.
+ * @param mob The mob
+ * @param other The other mob
+ */
+bool hostile_to(const Mob * mob, const Mob * other) {
+	return hostilities[mob->faction][other->faction];
+}
+
+/**
+ * Attack a mob, modified by the weapon of the attacker and the armour
+ * of the defender. Weapons which hit an area hit everything in it.
+ * @param attacker The mob doing the attacking.
+ * @param defender The mob being attacked.
+ */
+void attack_mob(Mob * attacker, Mob * defender) {
+	if(attacker->weapon != NULL && attacker->weapon->area != AREA_NONE) {
+		area_attack(attacker, defender);
+		return;
+	}
+
+	int damage = roll_damage(attacker, defender);
+
+	charge_action(attacker, ACTION_ATTACK);
+
+	/* Update the status */
+	if(attacker == attacker->level->player) {
+		const char * messages[] = {
+			"You attack the %s for %d damage.",
+			"You attack the %s for %d damage.",
+			"You attack the %s for %d damage.",
+			"You hit the %s for %d damage.",
+			"You hit the %s for %d damage.",
+			"You cleave the %s in twain for %d damage.",
+			NULL
+		};
+
+		status_push((const char *)random_choice(level_rng(attacker->level, RNG_COMBAT),
+		                                        (const void **)messages),
+		            defender->name,
+		            damage);
+	} else if(defender == defender->level->player) {
+		status_push("The %s attacks you for %d damage!",
+		            attacker->name,
+		            damage);
+	} else if(defender->level->player != NULL &&
+	          can_see_other(defender->level->player, defender)) {
+		status_push("The %s attacks the %s.",
+		            attacker->name,
+		            defender->name);
+	}
+
+	/* Damage the defender */
+	damage_mob(defender, (unsigned int) damage);
+
+	/* Call weapon/armour effects */
+	fight_effects(attacker, attacker->weapon, defender, damage);
+}
+
 /**
  * Damage a mob.
  * @param mob Entity to damage.
@@ -171,25 +314,32 @@ void attack_mob(Mob * attacker, Mob * defender) {
  * drops to zero or below.
  */
 bool damage_mob(Mob * mob, unsigned int damage) {
-	mob->health -= damage;
+	bool was_alive = mob_health(mob) > 0;
+
+	mob_health(mob) -= damage;
+
+	/* The body is cleared away at the end of the turn */
+	if(was_alive && mob_health(mob) <= 0) {
+		queue_death(mob->level, mob->id);
+	}
 
-	return (mob->health <= 0);
+	return (mob_health(mob) <= 0);
 }
 
 /**
- * Kill a mob - free it, and remove it from the lists.
+ * Kill a mob - free it, and remove it from the level.
  * @param mob The mob to kill
- * @return The next mob in the list, or NULL
  */
-Mob * kill_mob(Mob * mob) {
+void kill_mob(Mob * mob) {
 	if(mob->death_action != NULL) {
 		/* Any mob-specific freeing should happen here */
 		mob->death_action(mob);
 	}
 
 	Level * level = mob->level;
-	Cell * cell = level->cells[mob->xpos][mob->ypos];
-	Mob * next = fromlist(Mob, moblist, mob->moblist.next);
+	Cell * cell = level->cells[mob_xpos(mob)][mob_ypos(mob)];
+
+	clear_effects(mob);
 
 	/* Unwield its stuff */
 	if(mob->weapon != NULL) {
@@ -203,20 +353,21 @@ Mob * kill_mob(Mob * mob) {
 	}
 
 	/* Remove it from the cell */
-	cell->occupant = NULL;
+	if(cell->occupant == mob->id) {
+		cell->occupant = NO_MOB;
+	}
+	spatial_remove(level, mob->id, mob_xpos(mob), mob_ypos(mob));
 
-	/* Remove from the mob list */
-	level->mobs = drop(&mob->moblist);
+	/* Remove from the mob table, first letting go of anything it
+	   threw, as the id can be reused */
+	disown_projectiles(level, mob->id);
+	mobtable_remove(&level->mobtable, mob->id);
 
 	/* Drop its items */
-	if(mob->inventory != NULL) {
-		cell->items = append(cell->items, mob->inventory);
-	}
+	list_splice(&cell->items, &mob->inventory);
 
 	/* Free it */
 	xfree(mob);
-
-	return next;
 }
 
 /**
@@ -282,8 +433,8 @@ bool can_see_point(Level * level,
 bool can_see(Mob * mob, unsigned int x, unsigned int y) {
 	Level * level = mob->level;
 
-	unsigned int x0 = mob->xpos;
-	unsigned int y0 = mob->ypos;
+	unsigned int x0 = mob_xpos(mob);
+	unsigned int y0 = mob_ypos(mob);
 
 	if(!can_see_point(level, x0, y0, x, y)) {
 		return false;
@@ -293,7 +444,7 @@ bool can_see(Mob * mob, unsigned int x, unsigned int y) {
 		/* Cells can be seen if they're illuminated or the mob can see
 		 * in the dark */
 		return true;
-	} else if(sqrt(pow(abs((int) mob->xpos - (int) x), 2) + pow(abs((int) mob->ypos - (int) y), 2)) <= 5) {
+	} else if(sqrt(pow(abs((int) x0 - (int) x), 2) + pow(abs((int) y0 - (int) y), 2)) <= 5) {
 		/* Or if they're sufficiently close to the mob */
 		return true;
 	} else {
@@ -307,7 +458,7 @@ bool can_see(Mob * mob, unsigned int x, unsigned int y) {
  * @param mobb The other. It really doesn't matter which way around they are.
  */
 bool can_see_other(Mob * moba, Mob * mobb) {
-	return can_see(moba, mobb->xpos, mobb->ypos);
+	return can_see(moba, mob_xpos(mobb), mob_ypos(mobb));
 }
 
 /**
@@ -315,12 +466,17 @@ bool can_see_other(Mob * moba, Mob * mobb) {
  * @param mob The mob whose corpse should be dropped
  */
 void drop_corpse(struct Mob * mob) {
-	Cell * cell = mob->level->cells[mob->xpos][mob->ypos];
+	Cell * cell = mob->level->cells[mob_xpos(mob)][mob_ypos(mob)];
+
+	/* A pile rots away together, in time after the freshest corpse in
+	 * it; the events of those before then find it no longer due */
+	unsigned long expires = queue_event(mob->level, CORPSE_ROT_TURNS, EVENT_CORPSE_ROT, mob_xpos(mob), mob_ypos(mob));
+
 	/* Make sure we actually need to create a new corpse */
-	for (List * it = cell->items; it != NULL; it = it->next) {
-		Item * tmp = fromlist(Item, inventory, it);
+	list_foreach(Item, inventory, tmp, &cell->items) {
 		if (tmp->value == 4) {
 			tmp->count++;
+			tmp->expires = expires;
 			return;
 		}
 	}
@@ -328,8 +484,9 @@ void drop_corpse(struct Mob * mob) {
 	size_t len = strlen(mob->name) + strlen(" Corpse") + 1;
 	corpse->name = xcalloc(len, char);
 	snprintf(corpse->name, len, "%s%s", mob->name, " Corpse");
+	corpse->expires = expires;
 
-	cell->items = insert(cell->items, &corpse->inventory);
+	list_insert(&cell->items, &corpse->inventory);
 }
 
 /**
@@ -353,10 +510,14 @@ bool move_mob_level(Mob * mob, bool toprev) {
 		newy = newlevel->endy;
 	} else {
 		if (level->levels.next == NULL) {
-			/* no next level so make one */
-			Level * nextlevel = xalloc(Level);
-			nextlevel->depth = level->depth + 1;
-			build_level(nextlevel);
+			/* no next level so make one, unless it's been made
+			   already */
+			Level * nextlevel = take_pregenerated(level);
+			if(nextlevel == NULL) {
+				nextlevel = xalloc(Level);
+				nextlevel->depth = level->depth + 1;
+				build_level(nextlevel);
+			}
 			nextlevel->levels.prev = &level->levels;
 			level->levels.next = &nextlevel->levels;
 			/* Assumes only the player can create levels */
@@ -367,17 +528,23 @@ bool move_mob_level(Mob * mob, bool toprev) {
 		newy = newlevel->starty;
 	}
 
-	/* remove the mob from the current level */
-	mob->level->mobs = drop(&mob->moblist);
-	level->cells[mob->xpos][mob->ypos]->occupant = NULL;
+	/* The new level may be running in the background */
+	pthread_mutex_lock(&newlevel->lock);
 
-	/* Puts the mob in the new level, inserting
-	   it at the front of the list of mobs */
+	/* remove the mob from the current level */
+	level->cells[mob_xpos(mob)][mob_ypos(mob)]->occupant = NO_MOB;
+	spatial_remove(level, mob->id, mob_xpos(mob), mob_ypos(mob));
+
+	/* Puts the mob in the new level, keeping its components. Its id
+	   here is freed, so what it threw is no longer its */
+	move_effects(mob, level, newlevel);
+	disown_projectiles(level, mob->id);
+	mobtable_transfer(&level->mobtable, &newlevel->mobtable, mob->id);
 	mob->level = newlevel;
-	newlevel->mobs = insert(newlevel->mobs, &mob->moblist);
-	newlevel->cells[newx][newy]->occupant = mob;
-	mob->xpos = newx;
-	mob->ypos = newy;
+	newlevel->cells[newx][newy]->occupant = mob->id;
+	spatial_add(newlevel, mob->id, newx, newy);
+	mob_xpos(mob) = newx;
+	mob_ypos(mob) = newy;
 
 	if (mob == level->player) {
 		PlayerData * playerdata = (PlayerData *)level->player->data;
@@ -385,6 +552,10 @@ bool move_mob_level(Mob * mob, bool toprev) {
 		level->player = NULL;
 		newlevel->player = mob;
 
+		/* Their trail here goes cold rather than being left to lead
+		   hunters about while the level runs without them */
+		free_scent(level);
+
 		if(toprev) {
 			playerdata->terrain = fromlist(Terrain, levels,
 			                               playerdata->terrain->levels.prev);
@@ -402,27 +573,28 @@ bool move_mob_level(Mob * mob, bool toprev) {
 		}
 	}
 
+	pthread_mutex_unlock(&newlevel->lock);
+
+	/* Get the level below the player's ready */
+	if(mob == newlevel->player) {
+		pregenerate(newlevel);
+	}
+
 	return true;
 }
 
 /**
- * Drop the given item from the mob's inventory to the floor.
- * @param mob The mob which is doing the dropping
- * @param item The item to drop
+ * Take one of the given item out of the mob's inventory, unwielding
+ * it if need be.
+ * @param mob The mob which has the item
+ * @param item The item to take
+ * @return The item taken, which belongs to no inventory
  */
-void drop_item(Mob * mob, Item * item) {
-	Cell * cell = mob->level->cells[mob->xpos][mob->ypos];
-
+Item * take_item(Mob * mob, Item * item) {
         if (item->equipped) {
                 unwield_item(mob, item);
         }
 
-	/* Update the cell luminosity */
-	if(item->luminous) {
-		cell->luminosity ++;
-	}
-
-	/* Update the inventories */
 	if (item->count > 1) {
 		item->count--;
 		Item * cpy = xalloc(Item);
@@ -430,11 +602,41 @@ void drop_item(Mob * mob, Item * item) {
 		cpy->inventory.prev = NULL;
 		cpy->inventory.next = NULL;
 		cpy->count = 1;
-		cell->items = insert(cell->items, &cpy->inventory);
-	} else {
-		mob->inventory = drop(&item->inventory);
-		cell->items = insert(cell->items, &item->inventory);
+		return cpy;
 	}
+
+	list_drop(&mob->inventory, &item->inventory);
+	return item;
+}
+
+/**
+ * Put an item, which belongs to no inventory, on the floor.
+ * @param level The level
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ * @param item The item
+ */
+void place_item(Level * level, unsigned int x, unsigned int y, Item * item) {
+	Cell * cell = level->cells[x][y];
+
+	/* Update the cell luminosity, and leave a lit lantern to burn out */
+	if(item->luminous) {
+		cell->luminosity ++;
+		if(item->burns_out) {
+			item->expires = queue_event(level, LANTERN_TURNS, EVENT_LANTERN_OUT, x, y);
+		}
+	}
+
+	list_insert(&cell->items, &item->inventory);
+}
+
+/**
+ * Drop the given item from the mob's inventory to the floor.
+ * @param mob The mob which is doing the dropping
+ * @param item The item to drop
+ */
+void drop_item(Mob * mob, Item * item) {
+	place_item(mob->level, mob_xpos(mob), mob_ypos(mob), take_item(mob, item));
 }
 
 /**
@@ -459,7 +661,7 @@ void drop_items(Mob * mob, List ** items) {
  * @param item The item to get
  */
 void pickup_item(Mob * mob, Item * item) {
-	Cell * cell = mob->level->cells[mob->xpos][mob->ypos];
+	Cell * cell = mob->level->cells[mob_xpos(mob)][mob_ypos(mob)];
 
 	/* Update luminosity */
 	if(item->luminous) {
@@ -467,16 +669,15 @@ void pickup_item(Mob * mob, Item * item) {
 	}
 
 	/* Update inventories */
-	cell->items = drop(&item->inventory);
-	for (List * it = mob->inventory; it != NULL; it = it->next) {
-		Item * tmp = fromlist(Item, inventory, it);
+	list_drop(&cell->items, &item->inventory);
+	list_foreach(Item, inventory, tmp, &mob->inventory) {
 		if (strcmp(tmp->name, item->name) == 0) {
 			tmp->count += item->count;
 			xfree(item);
 			return;
 		}
 	}
-	mob->inventory = insert(mob->inventory, &item->inventory);
+	list_insert(&mob->inventory, &item->inventory);
 }
 
 /**
@@ -561,10 +762,10 @@ void unwield_item(Mob * mob, Item * item) {
  * @param amount Amount to heal by
  */
 void heal_mob(Mob * mob, unsigned int amount) {
-	mob->health += amount;
+	mob_health(mob) += amount;
 
-	if((unsigned int)mob->health > mob->max_health) {
-		mob->health = mob->max_health;
+	if((unsigned int)mob_health(mob) > mob_stats(mob)->max_health) {
+		mob_health(mob) = mob_stats(mob)->max_health;
 	}
 }
 
@@ -574,6 +775,8 @@ void heal_mob(Mob * mob, unsigned int amount) {
  * @param item The item to consume.
  */
 void consume_item(Mob * mob, Item * item) {
+	charge_action(mob, (item->type == DRINK) ? ACTION_QUAFF : ACTION_EAT);
+
 	if(item->effect != NULL) {
 		/* Apply the effect if the item has one */
 		item->effect(mob);
@@ -589,7 +792,7 @@ void consume_item(Mob * mob, Item * item) {
 	if (item->count > 1) {
 		item->count--;
 	} else {
-		mob->inventory = drop(&item->inventory);
+		list_drop(&mob->inventory, &item->inventory);
 		xfree(item);
 	}
 }
@@ -8,49 +8,55 @@ struct Level;
 #include "level.h"
 #include "utils.h"
 #include "list.h"
+#include "mobtable.h"
+
+/**
+ * The sides mobs are on. Mobs fight those of factions they're hostile
+ * to (see hostile_to), and leave the rest alone. Everything is hostile
+ * to the player.
+ */
+enum Faction {
+	FACTION_PLAYER,   /**< The player. */
+	FACTION_BEASTS,   /**< Small animals, which only bother the player. */
+	FACTION_ORCS,     /**< Orcs, at war with the pirates. */
+	FACTION_PIRATES,  /**< Cave pirates, at war with the orcs. */
+	FACTION_MONSTERS, /**< Things which prey on the beasts. */
+	FACTION_DRAGONS,  /**< Dragons, which eat everything. */
+	NUM_FACTIONS
+};
 
 /**
  * A mob is something which roams around the world, they are tied to a
- * level, and all the mobs in one level form a doubly-linked
- * list. There are a couple of callbacks associated with them to
- * determine what happens in certain situations.
+ * level. The data needed every turn (position, health, stats, AI, and
+ * effects) lives in the MobTable of the level, and is accessed with
+ * the mob_* macros below; this struct holds everything else. There
+ * are a couple of callbacks associated with them to determine what
+ * happens in certain situations.
  */
 typedef struct Mob {
-	List moblist; /**< The list of mobs to which this belongs */
-
 	struct Level * level; /**< The level the mob is in. */
-	unsigned int xpos;    /**< The X position. */
-	unsigned int ypos;    /**< The Y position. */
+	MobId id;             /**< The id of the mob in its level. */
+	unsigned int row;     /**< The row of the mob in the level's MobTable. */
 
 	char symbol;  /**< The symbol to use to render the mob. */
 	int colour;   /**< The colour to use to render the mob. */
 	bool is_bold; /**< Whether to render the mob bold. */
 
-	List * inventory; /**< List of items the mob is holding. */
+	ListHead inventory; /**< List of items the mob is holding. */
 	struct Item * weapon; /**< The weapon of the mob. */
 	struct Item * offhand; /**< The offhand weapon of the mob. */
 	struct Item * armour; /**< The armour of the mob. */
 
-	void (*turn_action)(struct Mob *);  /**< What to do every turn. */
 	void (*death_action)(struct Mob *); /**< What to do on death. */
 
-	int effect_duration; /**< How long the current efefct will last. */
-	void (*effect_action)(struct Mob *); /**< The effect to apply every turn. */
-
 	bool hostile; /**< A mob is hostile if the player can damage it. */
+	enum Faction faction; /**< The side the mob is on. */
 
 	char* name;       /**< The name of the mob (may be NULL for NPC). */
 	char* race;       /**< The race of the mob (may be NULL for NPC). */
 	char* profession; /**< The job of the mob (may be NULL for NPC). */
 	int score;        /**< The score of the mob (ignored for NPCs). */
 
-	unsigned int attack; /**< The unarmed attack strength of the mob. */
-	unsigned int defense; /**< The unarmoured defense strength of the mob. */
-
-	int health; /**< The current health, signed to prevent underflow. */
-	unsigned int max_health; /**< The maximum health. */
-	unsigned int con; /**< The constitution of the mob. */
-
 	bool darksight; /**< Whether the mob can see in the dark or not. */
 	unsigned int luminosity; /**< Number of light sources the mob is holding. */
 
@@ -60,23 +66,48 @@ typedef struct Mob {
 	void * data; /**< Mob type specific data, eg PlayerData */
 } Mob;
 
+/** The X position of a mob (an lvalue). */
+#define mob_xpos(M) ((M)->level->mobtable.xpos[(M)->row])
+
+/** The Y position of a mob (an lvalue). */
+#define mob_ypos(M) ((M)->level->mobtable.ypos[(M)->row])
+
+/** The health of a mob (an lvalue). */
+#define mob_health(M) ((M)->level->mobtable.health[(M)->row])
+
+/** The AI of a mob (an lvalue). */
+#define mob_ai(M) ((M)->level->mobtable.ai[(M)->row])
+
+/** Pointer to the MobStats of a mob. */
+#define mob_stats(M) (&(M)->level->mobtable.stats[(M)->row])
+
+/** Pointer to the list of Effects on a mob. */
+#define mob_effects(M) (&(M)->level->mobtable.effects[(M)->row])
+
+void register_mob(struct Level * level, struct Mob * mob);
+struct Mob * get_occupant(struct Level * level, unsigned int x, unsigned int y);
 bool move_mob(struct Mob * mob, unsigned int x, unsigned int y);
 bool move_mob_relative(struct Mob * mob, int xdiff, int ydiff);
 bool move_mob_level(Mob * mob, bool toprev);
 bool damage_mob(struct Mob * mob, unsigned int amount);
+int roll_blow(Rng * rng, int attack, const struct Item * weapon, Mob * defender);
+int roll_damage(Mob * attacker, Mob * defender);
+void fight_effects(Mob * attacker, struct Item * weapon, Mob * defender, int damage);
 void attack_mob(Mob * attacker, Mob * defender);
-struct Mob * kill_mob(struct Mob * mob);
+bool hostile_to(const Mob * mob, const Mob * other);
+void kill_mob(struct Mob * mob);
 bool can_see_point(struct Level * level,
                    unsigned int x0, unsigned int y0,
                    unsigned int x, unsigned int y);
 bool can_see(struct Mob * mob, unsigned int x, unsigned int y);
 bool can_see_other(struct Mob * moba, struct Mob * mobb);
-void simple_enemy_turn(struct Mob * enemy);
 void drop_corpse(struct Mob * mob);
+struct Item * take_item(struct Mob * mob, struct Item * item);
+void place_item(struct Level * level, unsigned int x, unsigned int y, struct Item * item);
 void drop_item(struct Mob * mob, struct Item * item);
-void drop_items(struct Mob * mob, struct List ** items);
+void drop_items(struct Mob * mob, List ** items);
 void pickup_item(struct Mob * mob, struct Item * item);
-void pickup_items(struct Mob * mob, struct List ** items);
+void pickup_items(struct Mob * mob, List ** items);
 void wield_item(struct Mob * mob, struct Item * item);
 void unwield_item(struct Mob * mob, struct Item * item);
 void heal_mob(struct Mob * mob, unsigned int amount);
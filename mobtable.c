@@ -0,0 +1,208 @@
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "mobtable.h"
+#include "mob.h"
+#include "utils.h"
+
+/**
+ * Make room for at least one more row.
+ * @param table The table to grow
+ */
+static void grow_rows(MobTable * table) {
+	if(table->count < table->capacity) {
+		return;
+	}
+
+	unsigned int capacity = (table->capacity == 0) ? 16 : table->capacity * 2;
+
+	table->id     = xrealloc(table->id,     capacity, MobId);
+	table->mob    = xrealloc(table->mob,    capacity, struct Mob *);
+	table->xpos   = xrealloc(table->xpos,   capacity, unsigned int);
+	table->ypos   = xrealloc(table->ypos,   capacity, unsigned int);
+	table->health = xrealloc(table->health, capacity, int);
+	table->stats  = xrealloc(table->stats,  capacity, MobStats);
+	table->ai     = xrealloc(table->ai,     capacity, enum MobAI);
+	table->effects = xrealloc(table->effects, capacity, ListHead);
+	table->energy = xrealloc(table->energy, capacity, int);
+	table->cost   = xrealloc(table->cost,   capacity, int);
+	table->ticket = xrealloc(table->ticket, capacity, unsigned long);
+	table->dormant = xrealloc(table->dormant, capacity, bool);
+	table->slept  = xrealloc(table->slept,  capacity, unsigned long);
+
+	table->capacity = capacity;
+}
+
+/**
+ * Get an unused id, allocating more if need be.
+ * @param table The table to get an id from
+ */
+static MobId new_id(MobTable * table) {
+	if(table->num_free > 0) {
+		table->num_free --;
+		return table->free_ids[table->num_free];
+	}
+
+	if(table->num_ids == table->id_capacity) {
+		unsigned int capacity = (table->id_capacity == 0) ? 16 : table->id_capacity * 2;
+
+		table->row      = xrealloc(table->row,      capacity, unsigned int);
+		table->free_ids = xrealloc(table->free_ids, capacity, MobId);
+
+		table->id_capacity = capacity;
+	}
+
+	if(table->num_ids == 0) {
+		/* Id 0 is NO_MOB, so is never handed out */
+		table->num_ids = 1;
+		table->row[NO_MOB] = NO_ROW;
+	}
+
+	MobId id = table->num_ids;
+	table->num_ids ++;
+
+	return id;
+}
+
+/**
+ * Add a mob to a table, with all of its components zeroed. The mob's
+ * id and row are updated.
+ * @param table The table to add to
+ * @param mob The mob to add
+ * @return The id of the mob
+ */
+MobId mobtable_add(MobTable * table, Mob * mob) {
+	assert(mob != NULL);
+
+	grow_rows(table);
+
+	MobId id = new_id(table);
+	unsigned int row = table->count;
+	table->count ++;
+
+	table->id[row] = id;
+	table->mob[row] = mob;
+	table->xpos[row] = 0;
+	table->ypos[row] = 0;
+	table->health[row] = 0;
+	memset(&table->stats[row], 0, sizeof(MobStats));
+	table->ai[row] = AI_NONE;
+	memset(&table->effects[row], 0, sizeof(ListHead));
+	table->energy[row] = 0;
+	table->cost[row] = 0;
+	table->ticket[row] = 0;
+	table->dormant[row] = false;
+	table->slept[row] = 0;
+
+	table->row[id] = row;
+	mob->id = id;
+	mob->row = row;
+
+	return id;
+}
+
+/**
+ * Remove a mob from a table. The last row is moved into the gap, and
+ * the id becomes available for reuse.
+ * @param table The table to remove from
+ * @param id The id of the mob to remove
+ */
+void mobtable_remove(MobTable * table, MobId id) {
+	assert(id != NO_MOB && id < table->num_ids);
+
+	unsigned int row = table->row[id];
+	unsigned int last = table->count - 1;
+
+	assert(row != NO_ROW);
+
+	if(row != last) {
+		table->id[row]     = table->id[last];
+		table->mob[row]    = table->mob[last];
+		table->xpos[row]   = table->xpos[last];
+		table->ypos[row]   = table->ypos[last];
+		table->health[row] = table->health[last];
+		table->stats[row]  = table->stats[last];
+		table->ai[row]     = table->ai[last];
+		table->effects[row] = table->effects[last];
+		table->energy[row] = table->energy[last];
+		table->cost[row]   = table->cost[last];
+		table->ticket[row] = table->ticket[last];
+		table->dormant[row] = table->dormant[last];
+		table->slept[row]  = table->slept[last];
+
+		table->row[table->id[row]] = row;
+		table->mob[row]->row = row;
+	}
+
+	table->count --;
+	table->row[id] = NO_ROW;
+	table->free_ids[table->num_free] = id;
+	table->num_free ++;
+}
+
+/**
+ * Move a mob from one table to another, keeping all of its
+ * components. The mob gets a new id in the destination table.
+ * @param from The table the mob is currently in
+ * @param to The table to move the mob to
+ * @param id The id of the mob in the source table
+ * @return The new id of the mob
+ */
+MobId mobtable_transfer(MobTable * from, MobTable * to, MobId id) {
+	unsigned int src = from->row[id];
+	Mob * mob = from->mob[src];
+
+	MobId newid = mobtable_add(to, mob);
+	unsigned int dst = mob->row;
+
+	to->xpos[dst]   = from->xpos[src];
+	to->ypos[dst]   = from->ypos[src];
+	to->health[dst] = from->health[src];
+	to->stats[dst]  = from->stats[src];
+	to->ai[dst]     = from->ai[src];
+	to->effects[dst] = from->effects[src];
+	to->energy[dst] = from->energy[src];
+	to->cost[dst]   = from->cost[src];
+
+	mobtable_remove(from, id);
+
+	return newid;
+}
+
+/**
+ * Look up a mob by id.
+ * @param table The table to search
+ * @param id The id of the mob
+ * @return The mob, or NULL if there is no such mob
+ */
+Mob * mobtable_get(const MobTable * table, MobId id) {
+	if(id == NO_MOB || id >= table->num_ids || table->row[id] == NO_ROW) {
+		return NULL;
+	}
+
+	return table->mob[table->row[id]];
+}
+
+/**
+ * Free the storage of a table (but not the mobs in it).
+ * @param table The table to free
+ */
+void mobtable_free(MobTable * table) {
+	xfree(table->id);
+	xfree(table->mob);
+	xfree(table->xpos);
+	xfree(table->ypos);
+	xfree(table->health);
+	xfree(table->stats);
+	xfree(table->ai);
+	xfree(table->effects);
+	xfree(table->energy);
+	xfree(table->cost);
+	xfree(table->ticket);
+	xfree(table->dormant);
+	xfree(table->slept);
+	xfree(table->row);
+	xfree(table->free_ids);
+	memset(table, 0, sizeof(MobTable));
+}
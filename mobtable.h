@@ -0,0 +1,76 @@
+#ifndef MOBTABLE_H
+#define MOBTABLE_H
+
+#include <stdbool.h>
+
+#include "list.h"
+
+struct Mob;
+
+/**
+ * Identifies a mob within its level. Ids are stable for as long as
+ * the mob stays in the level, and are what cells refer to.
+ */
+typedef unsigned int MobId;
+
+/** The id which never refers to a mob. */
+#define NO_MOB 0
+
+/** The row index of an id which is not in use. */
+#define NO_ROW ((unsigned int) -1)
+
+/**
+ * What a mob does with its turn.
+ */
+enum MobAI { AI_NONE, AI_PLAYER, AI_SIMPLE, AI_HUNTER };
+
+/**
+ * The combat stats of a mob.
+ */
+typedef struct MobStats {
+	unsigned int attack; /**< The unarmed attack strength of the mob. */
+	unsigned int defense; /**< The unarmoured defense strength of the mob. */
+	unsigned int max_health; /**< The maximum health. */
+	unsigned int con; /**< The constitution of the mob. */
+	unsigned int speed; /**< The energy gained per tick (see schedule.h). */
+} MobStats;
+
+/**
+ * The mobs in a level, stored as dense arrays of components with one
+ * row per mob, so that the turn loop and AI walk contiguous memory
+ * rather than chasing pointers. Rows are packed (removal moves the
+ * last row into the gap), so mobs are referred to by id, which maps
+ * to a row through the sparse row array. A zeroed MobTable is empty.
+ */
+typedef struct MobTable {
+	unsigned int count;    /**< The number of rows in use. */
+	unsigned int capacity; /**< The number of rows allocated. */
+
+	MobId * id;             /**< The id of each row. */
+	struct Mob ** mob;      /**< The rest of the mob data. */
+	unsigned int * xpos;    /**< The X position. */
+	unsigned int * ypos;    /**< The Y position. */
+	int * health;           /**< The current health, signed to prevent underflow. */
+	MobStats * stats;       /**< The combat stats. */
+	enum MobAI * ai;        /**< What to do every turn. */
+	ListHead * effects;     /**< The effects the mob is suffering from (see effect.h). */
+	int * energy;           /**< The energy banked (negative if in debt). */
+	int * cost;             /**< The energy spent so far this turn. */
+	unsigned long * ticket; /**< The schedule entry which is current. */
+	bool * dormant;         /**< Whether the mob is dormant (unscheduled). */
+	unsigned long * slept;  /**< The level time at which the mob went dormant. */
+
+	unsigned int * row;     /**< The row of each id (NO_ROW if unused). */
+	unsigned int num_ids;   /**< The number of ids allocated. */
+	unsigned int id_capacity; /**< The number of ids there is room for. */
+	MobId * free_ids;       /**< Stack of ids available for reuse. */
+	unsigned int num_free;  /**< The number of ids available for reuse. */
+} MobTable;
+
+MobId mobtable_add(MobTable * table, struct Mob * mob);
+void mobtable_remove(MobTable * table, MobId id);
+MobId mobtable_transfer(MobTable * from, MobTable * to, MobId id);
+struct Mob * mobtable_get(const MobTable * table, MobId id);
+void mobtable_free(MobTable * table);
+
+#endif /* MOBTABLE_H */
@@ -11,6 +11,9 @@
 #include "effect.h"
 #include "status.h"
 #include "list.h"
+#include "schedule.h"
+#include "realtime.h"
+#include "projectile.h"
 
 const char * names[] = {"Colin",
                         NULL};
@@ -33,15 +36,20 @@ const char * professions[] = {"Miner",
                               NULL};
 
 extern bool quit;
+extern bool realtime;
+extern unsigned long game_seed;
 
 /**
  * Randomise a player's name, race, and profession.
  * @param player The player
  */
 static void randomise_player(Mob * player) {
-	player->name = strdup((char *) random_choice((const void**) names));
-	player->race = strdup((char *) random_choice((const void**) races));
-	player->profession = strdup((char *) random_choice((const void**) professions));
+	Rng rng;
+	rng_stream(&rng, RNG_CHARACTER, 0);
+
+	player->name = strdup((char *) random_choice(&rng, (const void**) names));
+	player->race = strdup((char *) random_choice(&rng, (const void**) races));
+	player->profession = strdup((char *) random_choice(&rng, (const void**) professions));
 }
 
 #ifndef AUTOPLAY
@@ -84,39 +92,41 @@ static void design_player(Mob * player) {
  * @param player The player
  */
 static void apply_race(Mob * player) {
+	MobStats * stats = mob_stats(player);
+
 	if(strcmp(player->race, "Human") == 0) {
-		player->attack     = 3;
-		player->defense    = 2;
-		player->max_health = 100;
-		player->con        = 3;
+		stats->attack     = 3;
+		stats->defense    = 2;
+		stats->max_health = 100;
+		stats->con        = 3;
 	} else if(strcmp(player->race, "Dutch") == 0) {
-		player->attack     = 2;
-		player->defense    = 3;
-		player->max_health = 100;
-		player->con        = 3;
+		stats->attack     = 2;
+		stats->defense    = 3;
+		stats->max_health = 100;
+		stats->con        = 3;
 	} else if(strcmp(player->race, "Elf") == 0) {
-		player->attack     = 5;
-		player->defense    = 1;
-		player->max_health = 125;
-		player->con        = 5;
+		stats->attack     = 5;
+		stats->defense    = 1;
+		stats->max_health = 125;
+		stats->con        = 5;
 	} else if(strcmp(player->race, "Dwarf") == 0) {
-		player->attack     = 3;
-		player->defense    = 5;
-		player->max_health = 100;
-		player->con        = 2;
+		stats->attack     = 3;
+		stats->defense    = 5;
+		stats->max_health = 100;
+		stats->con        = 2;
 	} else if(strcmp(player->race, "Halfling") == 0) {
-		player->attack     = 2;
-		player->defense    = 2;
-		player->max_health = 150;
-		player->con        = 2;
+		stats->attack     = 2;
+		stats->defense    = 2;
+		stats->max_health = 150;
+		stats->con        = 2;
 	} else if(strcmp(player->race, "Quarterling") == 0) {
-		player->attack     = 1;
-		player->defense    = 1;
-		player->max_health = 175;
-		player->con        = 1;
+		stats->attack     = 1;
+		stats->defense    = 1;
+		stats->max_health = 175;
+		stats->con        = 1;
 	}
 
-	player->health = player->max_health;
+	mob_health(player) = stats->max_health;
 }
 
 /**
@@ -151,21 +161,26 @@ static void apply_profession(Mob * player) {
 		armour = clone_item(FURSUIT);
 	}
 
-	player->inventory = insert(player->inventory, &weapon->inventory);
-	player->inventory = insert(player->inventory, &armour->inventory);
+	list_insert(&player->inventory, &weapon->inventory);
+	list_insert(&player->inventory, &armour->inventory);
 }
 
 /**
  * Create and return a new player. This prompts the user for stuff,
- * and clears the screen when it is done.
+ * and clears the screen when it is done. The player belongs to the
+ * level, but has not been placed in it yet.
+ * @param level The level to create the player in.
  */
-Mob * create_player() {
+Mob * create_player(Level * level) {
 	Mob * player = xalloc(Mob);
+	register_mob(level, player);
 	player->symbol = '@';
 	player->colour = COLOR_WHITE;
 	player->is_bold = true;
-	player->turn_action = &player_turn;
 	player->death_action = &player_death;
+	player->faction = FACTION_PLAYER;
+	mob_ai(player) = AI_PLAYER;
+	mob_stats(player)->speed = NORMAL_SPEED;
 
 	/* Initialise the terrain knowledge to nothing */
 	PlayerData * playerdata = xalloc(PlayerData);
@@ -178,8 +193,8 @@ Mob * create_player() {
 
 	Item * potion = clone_item(C_POISON_POTION);
 
-	player->inventory = insert(player->inventory, &lantern->inventory);
-	player->inventory = insert(player->inventory, &potion->inventory);
+	list_insert(&player->inventory, &lantern->inventory);
+	list_insert(&player->inventory, &potion->inventory);
 
 	/* Pick the name, race, and profession */
 	clear();
@@ -222,7 +237,7 @@ Mob * create_player() {
  * @return If the player damaged a mob.
  */
 bool attackmove(Mob * player, unsigned int x, unsigned int y) {
-	Mob * mob = player->level->cells[x][y]->occupant;
+	Mob * mob = get_occupant(player->level, x, y);
 
 	if(!move_mob(player, x, y) && mob != NULL && mob->hostile) {
 		attack_mob(player, mob);
@@ -239,23 +254,43 @@ bool attackmove(Mob * player, unsigned int x, unsigned int y) {
  * @return If the player damaged a mob.
  */
 bool attackmove_relative(Mob * player, int xdiff, int ydiff) {
-	unsigned int x = player->xpos + xdiff;
-	unsigned int y = player->ypos + ydiff;
+	unsigned int x = mob_xpos(player) + xdiff;
+	unsigned int y = mob_ypos(player) + ydiff;
 
 	return attackmove(player, x, y);
 }
 
+#ifndef AUTOPLAY
+/**
+ * Read a key. In real time, keys come from the queue of those pressed
+ * since the last tick.
+ * @param wait Wait for a key if none are queued (always, outside real time).
+ * @return The key, or ERR if none were waiting.
+ */
+static int read_key(bool wait) {
+	int ch = realtime ? input_next() : ERR;
+
+	if(ch == ERR && (wait || !realtime)) {
+		ch = getch();
+	}
+
+	return ch;
+}
+#endif // AUTOPLAY
+
 /**
  * Wait for a direction. Returns the direction and the character.
  * @param allow_nop Allow a null move.
+ * @param wait Wait for a key even in real time.
  */
-static Direction select_direction(Mob * player, bool allow_nop) {
+static Direction select_direction(Mob * player, bool allow_nop, bool wait) {
 #ifdef AUTOPLAY
 	return autoplay_select_direction(player);
 	(void) allow_nop;
+	(void) wait;
 #else
 	(void) player;
-	int ch = getch();
+	int ch = read_key(wait);
 	Direction out = {.dx = 0, .dy = 0, .ch = 0};
 
 	switch(ch) {
@@ -324,13 +359,14 @@ static Direction select_direction(Mob * player, bool allow_nop) {
 }
 
 /**
- * Wait for user input, and then act accordingly.
+ * Wait for user input, and then act accordingly. In real time, this
+ * doesn't wait: if no key has been pressed, the player stands still.
  * @param player Player entity.
  */
 void player_turn(Mob * player) {
 	List ** items;
 	Item * item;
-	Cell * current_cell = player->level->cells[player->xpos][player->ypos];
+	Cell * current_cell = player->level->cells[mob_xpos(player)][mob_ypos(player)];
 	bool done = false;
 
 	bool move = false;
@@ -345,7 +381,12 @@ void player_turn(Mob * player) {
 		  display_level(player->level);
 #endif // AUTOPLAY
 
-		Direction dir = select_direction(player, true);
+		Direction dir = select_direction(player, true, false);
+
+		/* In real time, with nothing pressed, the player stands still */
+		if(dir.ch == ERR) {
+			break;
+		}
 
 		/* Movement in a level */
 		if(dir.ch == 0) {
@@ -375,11 +416,11 @@ void player_turn(Mob * player) {
 
 			/* Inventory management */
 		case 'i':
-			display_inventory(player->inventory, "Inventory Contents:");
+			display_inventory(&player->inventory, "Inventory Contents:");
 			break;
 
 		case 'd':
-			items = choose_items(player->inventory, "Select items to drop:");
+			items = choose_items(&player->inventory, "Select items to drop:");
 
 			/* Update the status */
 			for(unsigned int i = 0; items[i] != NULL; i++) {
@@ -392,7 +433,7 @@ void player_turn(Mob * player) {
 			break;
 
 		case ',':
-			items = choose_items(current_cell->items, "Select items to pick up:");
+			items = choose_items(&current_cell->items, "Select items to pick up:");
 
 			for(unsigned int i = 0; items[i] != NULL; i++) {
 				Item * item = fromlist(Item, inventory, items[i]);
@@ -404,7 +445,7 @@ void player_turn(Mob * player) {
 			break;
 
 		case 'w':
-			item = choose_item_by_type(player->inventory,
+			item = choose_item_by_type(&player->inventory,
 			                           WEAPON,
 			                           "Select a weapon to equip",
 			                           true);
@@ -434,7 +475,7 @@ void player_turn(Mob * player) {
 			break;
 
 		case 'W':
-			item = choose_item_by_type(player->inventory,
+			item = choose_item_by_type(&player->inventory,
 			                           ARMOUR,
 			                           "Select some armour to wear",
 			                           false);
@@ -446,7 +487,7 @@ void player_turn(Mob * player) {
 
 		/* Food and drink */
 		case 'e':
-			item = choose_item_by_type(player->inventory,
+			item = choose_item_by_type(&player->inventory,
 			                           FOOD,
 			                           "Select some food to eat",
 			                           false);
@@ -457,7 +498,7 @@ void player_turn(Mob * player) {
 			break;
 
 		case 'q':
-			item = choose_item_by_type(player->inventory,
+			item = choose_item_by_type(&player->inventory,
 			                           DRINK,
 			                           "Select a drink",
 			                           false);
@@ -473,26 +514,10 @@ void player_turn(Mob * player) {
 				status_push("You do not have a ranged weapon equipped!");
 				break;
 			}
-			dir = select_direction(player, false);
-			int curx = player->xpos;
-			int cury = player->ypos;
+			dir = select_direction(player, false, true);
 
 			if (dir.dx != 0 || dir.dy != 0) {
-				curx += dir.dx;
-				cury += dir.dy;
-				while(player->level->cells[curx][cury]->solid == false) {
-					if (player->level->cells[curx][cury]->occupant != NULL) {
-						int tmpx, tmpy;
-						attack_mob(player, player->level->cells[curx][cury]->occupant);
-						tmpx = player->xpos, tmpy = player->ypos;
-						player->xpos = curx, player->ypos = cury;
-						drop_item(player, player->weapon);
-						player->xpos = tmpx, player->ypos = tmpy;
-						break;
-					}
-					curx += dir.dx;
-					cury += dir.dy;
-				}
+				throw_item(player, player->weapon, dir.dx, dir.dy);
 			}
 			break;
 
@@ -518,8 +543,7 @@ void player_turn(Mob * player) {
 void player_death(Mob * player) {
 	clear();
 
-	for(List * list = player->inventory; list != NULL; list = list->next) {
-		Item * item = fromlist(Item, inventory, list);
+	list_foreach(Item, inventory, item, &player->inventory) {
 		if (item->type == VALUABLE) {
 			player->score += item->value;
 		}
@@ -542,6 +566,7 @@ void player_death(Mob * player) {
 
 	mvaddprintf(9, 10, "Oh dear, you died. :(");
 	mvaddprintf(10, 10, "Score: %i", player->score);
+	mvaddprintf(11, 10, "Seed: %lu", game_seed);
 	mvaddprintf(20, 10, "Press any key to exit");
 
 	quit = true;
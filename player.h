@@ -28,7 +28,7 @@ typedef struct Direction {
 	int ch; /**< The character, if it wasn't a direction */
 } Direction;
 
-Mob * create_player(void);
+Mob * create_player(Level * level);
 bool attackmove(struct Mob * player, unsigned int xdiff, unsigned int ydiff);
 bool attackmove_relative(struct Mob * player, int xdiff, int ydiff);
 void player_turn(Mob * player);
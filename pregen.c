@@ -0,0 +1,143 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "pregen.h"
+#include "utils.h"
+
+/**
+ * A level being built ahead of time, below the deepest level so far.
+ * As everything random about a level follows from the game seed and
+ * its depth, it comes out the same as it would have if built when
+ * needed.
+ */
+typedef struct Pregen {
+	Level * above;    /**< The level it goes below. */
+	Level * level;    /**< The level being built. */
+	pthread_t thread; /**< The worker building it. */
+	bool ready;       /**< Whether it's been built. */
+	struct Pregen * next; /**< The next abandoned job, once abandoned. */
+} Pregen;
+
+/** The level being built, if any. Only the main thread changes this. */
+static Pregen * pending = NULL;
+
+/** Levels no longer wanted, which may still be being built. Only the
+ * main thread changes this. */
+static Pregen * abandoned = NULL;
+
+/** Held while the ready flag is looked at. */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Build a level, and note that it's ready.
+ * @param arg The Pregen
+ */
+static void * build_pending(void * arg) {
+	Pregen * job = (Pregen *) arg;
+
+	build_level(job->level);
+
+	pthread_mutex_lock(&lock);
+	job->ready = true;
+	pthread_mutex_unlock(&lock);
+
+	return NULL;
+}
+
+/**
+ * Join the workers of abandoned levels, and throw the levels away.
+ * @param wait Whether to wait for those still being built, or leave
+ * them for later
+ */
+static void reap_abandoned(bool wait) {
+	Pregen ** link = &abandoned;
+
+	while(*link != NULL) {
+		Pregen * job = *link;
+
+		pthread_mutex_lock(&lock);
+		bool ready = job->ready;
+		pthread_mutex_unlock(&lock);
+
+		if(!ready && !wait) {
+			link = &job->next;
+			continue;
+		}
+
+		*link = job->next;
+		pthread_join(job->thread, NULL);
+		free_level(job->level);
+		xfree(job);
+	}
+}
+
+/**
+ * Start building the level below a level on a worker, if there isn't
+ * one already and none is being built.
+ * @param level The level
+ */
+void pregenerate(Level * level) {
+	reap_abandoned(false);
+
+	if(level->levels.next != NULL || pending != NULL) {
+		return;
+	}
+
+	Pregen * job = xalloc(Pregen);
+	job->above = level;
+	job->level = xalloc(Level);
+	job->level->depth = level->depth + 1;
+
+	if(pthread_create(&job->thread, NULL, &build_pending, job) != 0) {
+		xfree(job->level);
+		xfree(job);
+		return;
+	}
+
+	pending = job;
+}
+
+/**
+ * Take the level built to go below a level, if it's ready. If it's
+ * still being built, it's abandoned, to be thrown away once done, and
+ * the level should be built as normal: it'll come out the same.
+ * @param level The level
+ * @return The level built, or NULL if there isn't one ready
+ */
+Level * take_pregenerated(Level * level) {
+	Pregen * job = pending;
+
+	if(job == NULL || job->above != level) {
+		return NULL;
+	}
+	pending = NULL;
+
+	pthread_mutex_lock(&lock);
+	bool ready = job->ready;
+	pthread_mutex_unlock(&lock);
+
+	if(!ready) {
+		job->next = abandoned;
+		abandoned = job;
+		return NULL;
+	}
+
+	pthread_join(job->thread, NULL);
+	Level * built = job->level;
+	xfree(job);
+	return built;
+}
+
+/**
+ * Wait for any levels being built, wanted or not, and throw them away.
+ */
+void pregenerate_finish(void) {
+	if(pending != NULL) {
+		pending->next = abandoned;
+		abandoned = pending;
+		pending = NULL;
+	}
+
+	reap_abandoned(true);
+}
@@ -0,0 +1,10 @@
+#ifndef PREGEN_H
+#define PREGEN_H
+
+#include "level.h"
+
+void pregenerate(Level * level);
+Level * take_pregenerated(Level * level);
+void pregenerate_finish(void);
+
+#endif /* PREGEN_H */
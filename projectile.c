@@ -0,0 +1,167 @@
+#include <stdlib.h>
+
+#include "projectile.h"
+#include "schedule.h"
+#include "status.h"
+#include "utils.h"
+
+/**
+ * Set something flying.
+ * @param level The level
+ * @param x The X it starts from
+ * @param y The Y it starts from
+ * @param dx The way it goes in X (in [-1,0,1])
+ * @param dy The way it goes in Y (in [-1,0,1])
+ * @param speed The cells it flies in a turn
+ * @param range The most cells it flies
+ * @param owner Who fired it (NO_MOB for traps and the like)
+ * @param power The attack it hits with, if the owner is gone by then
+ * @param item What lands where it stops (may be NULL)
+ */
+void launch_projectile(Level * level,
+                       unsigned int x, unsigned int y, int dx, int dy,
+                       unsigned int speed, unsigned int range,
+                       MobId owner, int power, Item * item) {
+	if(level->projectiles == NULL) {
+		level->projectiles = xalloc(ProjectilePool);
+	}
+
+	ProjectilePool * pool = level->projectiles;
+	if(pool->count == pool->capacity) {
+		pool->capacity = (pool->capacity == 0) ? 8 : pool->capacity * 2;
+		pool->projectiles = xrealloc(pool->projectiles, pool->capacity, Projectile);
+	}
+
+	pool->projectiles[pool->count ++] = (Projectile) {
+		.x = x, .y = y, .dx = dx, .dy = dy,
+		.speed = speed, .range = range,
+		.owner = owner, .power = power, .item = item
+	};
+}
+
+/**
+ * Throw an item (such as a ranged weapon), which hits as if the
+ * thrower struck with it.
+ * @param mob The thrower
+ * @param item The item, from the thrower's inventory
+ * @param dx The way to throw it in X (in [-1,0,1])
+ * @param dy The way to throw it in Y (in [-1,0,1])
+ */
+void throw_item(Mob * mob, Item * item, int dx, int dy) {
+	charge_action(mob, ACTION_ATTACK);
+	launch_projectile(mob->level, mob_xpos(mob), mob_ypos(mob), dx, dy,
+	                  THROW_SPEED, LEVELWIDTH, mob->id, mob_stats(mob)->attack,
+	                  take_item(mob, item));
+}
+
+/**
+ * A projectile hits a mob. If whoever fired it is still about, it hits
+ * as a blow from them with what it carries, effects and all.
+ * @param level The level
+ * @param projectile The projectile
+ * @param target The mob hit
+ */
+static void hit_mob(Level * level, const Projectile * projectile, Mob * target) {
+	Mob * owner = mobtable_get(&level->mobtable, projectile->owner);
+	int attack = (owner != NULL) ? (int) mob_stats(owner)->attack : projectile->power;
+	int damage = roll_blow(level_rng(level, RNG_COMBAT), attack, projectile->item, target);
+
+	const char * name = (projectile->item != NULL) ? projectile->item->name : "missile";
+
+	if(target == level->player) {
+		status_push("The %s hits you for %d damage!", name, damage);
+	} else if(owner != NULL && owner == level->player) {
+		status_push("The %s hits the %s for %d damage.", name, target->name, damage);
+	}
+
+	damage_mob(target, (unsigned int) damage);
+
+	if(owner != NULL) {
+		fight_effects(owner, projectile->item, target, damage);
+	}
+}
+
+/**
+ * Advance every projectile in a level by a turn. Each flies until it
+ * has gone as far as its speed takes it, hits a mob, hits something
+ * solid (stopping short of it), or runs out of range; those which stop
+ * drop what they carry and are packed out of the pool.
+ * @param level The level
+ */
+void run_projectiles(Level * level) {
+	ProjectilePool * pool = level->projectiles;
+
+	if(pool == NULL || pool->count == 0) {
+		return;
+	}
+
+	unsigned int kept = 0;
+	for(unsigned int i = 0; i < pool->count; i++) {
+		Projectile * projectile = &pool->projectiles[i];
+		bool flying = true;
+
+		for(unsigned int step = 0; step < projectile->speed && flying; step++) {
+			unsigned int x = projectile->x + projectile->dx;
+			unsigned int y = projectile->y + projectile->dy;
+			Cell * cell = level->cells[x][y];
+
+			if(projectile->range == 0 || cell->solid) {
+				flying = false;
+				break;
+			}
+
+			projectile->x = x;
+			projectile->y = y;
+			projectile->range --;
+
+			Mob * target = mobtable_get(&level->mobtable, cell->occupant);
+			if(target != NULL && target->id != projectile->owner && mob_health(target) > 0) {
+				hit_mob(level, projectile, target);
+				flying = false;
+			}
+		}
+
+		if(flying) {
+			pool->projectiles[kept ++] = *projectile;
+		} else if(projectile->item != NULL) {
+			place_item(level, projectile->x, projectile->y, projectile->item);
+		}
+	}
+
+	pool->count = kept;
+}
+
+/**
+ * Forget who fired a mob's projectiles, as it is leaving the level (or
+ * dying) and its id may be handed out again while they fly. They go on
+ * to hit with the attack they were fired with.
+ * @param level The level
+ * @param owner The mob
+ */
+void disown_projectiles(Level * level, MobId owner) {
+	if(level->projectiles == NULL) {
+		return;
+	}
+
+	for(unsigned int i = 0; i < level->projectiles->count; i++) {
+		if(level->projectiles->projectiles[i].owner == owner) {
+			level->projectiles->projectiles[i].owner = NO_MOB;
+		}
+	}
+}
+
+/**
+ * Free the projectiles of a level, and whatever they carry.
+ * @param level The level
+ */
+void free_projectiles(Level * level) {
+	if(level->projectiles == NULL) {
+		return;
+	}
+
+	for(unsigned int i = 0; i < level->projectiles->count; i++) {
+		xfree(level->projectiles->projectiles[i].item);
+	}
+	xfree(level->projectiles->projectiles);
+	xfree(level->projectiles);
+}
@@ -0,0 +1,44 @@
+#ifndef PROJECTILE_H
+#define PROJECTILE_H
+
+#include "mob.h"
+#include "level.h"
+#include "item.h"
+
+/** How many cells a thrown weapon flies in a turn. */
+#define THROW_SPEED 8
+
+/**
+ * Something flying across a level. It carries an attack, and
+ * (possibly) an item which lands where it stops.
+ */
+typedef struct Projectile {
+	unsigned int x, y;  /**< Where it is. */
+	int dx, dy;         /**< The way it's going (each in [-1,0,1]). */
+	unsigned int speed; /**< The cells it flies in a turn. */
+	unsigned int range; /**< The cells it has left to fly. */
+	MobId owner;        /**< Who fired it (NO_MOB once they're gone from the level). */
+	int power;          /**< The attack it hits with, if whoever fired it is gone. */
+	Item * item;        /**< What lands where it stops, or NULL. */
+} Projectile;
+
+/**
+ * The projectiles in flight in a level, packed together and advanced
+ * together once a turn.
+ */
+typedef struct ProjectilePool {
+	Projectile * projectiles; /**< The projectiles, in the order they were fired. */
+	unsigned int count;       /**< The number in flight. */
+	unsigned int capacity;    /**< The size of projectiles. */
+} ProjectilePool;
+
+void launch_projectile(Level * level,
+                       unsigned int x, unsigned int y, int dx, int dy,
+                       unsigned int speed, unsigned int range,
+                       MobId owner, int power, Item * item);
+void throw_item(Mob * mob, Item * item, int dx, int dy);
+void run_projectiles(Level * level);
+void disown_projectiles(Level * level, MobId owner);
+void free_projectiles(Level * level);
+
+#endif /* PROJECTILE_H */
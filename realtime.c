@@ -0,0 +1,130 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <curses.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "realtime.h"
+
+/** Keypresses waiting to be acted on, oldest first. */
+static int queue[INPUT_QUEUE_SIZE];
+
+/** The position of the oldest keypress in the queue. */
+static unsigned int queue_start = 0;
+
+/** The number of keypresses in the queue. */
+static unsigned int queue_length = 0;
+
+/** When the current tick started, in nanoseconds. */
+static long long tick_start = 0;
+
+/** When the next tick is due to start, in nanoseconds. */
+static long long next_tick = 0;
+
+/** The number of ticks run. */
+static unsigned long ticks = 0;
+
+/** The number of ticks which took longer than REALTIME_TICK_MS. */
+static unsigned long late_ticks = 0;
+
+/** The total and longest time taken to run a tick, in nanoseconds. */
+static long long total_time = 0, worst_time = 0;
+
+/**
+ * The time on a monotonic clock, in nanoseconds.
+ */
+static long long now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Read any keys pressed since the last poll into the queue, without
+ * waiting. If the queue is full, further keys are dropped.
+ */
+static void input_poll(void) {
+	nodelay(stdscr, true);
+
+	int ch;
+	while((ch = getch()) != ERR) {
+		if(queue_length < INPUT_QUEUE_SIZE) {
+			queue[(queue_start + queue_length) % INPUT_QUEUE_SIZE] = ch;
+			queue_length ++;
+		}
+	}
+
+	/* Everything else (menus, prompts) still waits for a key */
+	nodelay(stdscr, false);
+}
+
+/**
+ * Take the oldest key from the queue.
+ * @return The key, or ERR if none are waiting.
+ */
+int input_next(void) {
+	if(queue_length == 0) {
+		return ERR;
+	}
+
+	int ch = queue[queue_start];
+	queue_start = (queue_start + 1) % INPUT_QUEUE_SIZE;
+	queue_length --;
+
+	return ch;
+}
+
+/**
+ * Start a real-time tick, picking up the keys pressed since the last.
+ */
+void realtime_tick_start(void) {
+	tick_start = now();
+	if(next_tick == 0) {
+		next_tick = tick_start;
+	}
+
+	input_poll();
+}
+
+/**
+ * Finish a real-time tick: record how long it took, and sleep until
+ * the next one is due. A tick which overruns delays the next rather
+ * than making the following ones hurry to catch up.
+ */
+void realtime_tick_end(void) {
+	long long end = now();
+	long long taken = end - tick_start;
+
+	ticks ++;
+	total_time += taken;
+	if(taken > worst_time) {
+		worst_time = taken;
+	}
+
+	next_tick += REALTIME_TICK_MS * 1000000LL;
+	if(end > next_tick) {
+		late_ticks ++;
+		next_tick = end;
+		return;
+	}
+
+	long long wait = next_tick - end;
+	struct timespec ts = {.tv_sec = wait / 1000000000LL, .tv_nsec = wait % 1000000000LL};
+	nanosleep(&ts, NULL);
+}
+
+/**
+ * Print the tick timings. This should be called after curses has been
+ * shut down.
+ */
+void realtime_report(void) {
+	if(ticks == 0) {
+		return;
+	}
+
+	printf("Real-time: %lu ticks, %.2f ms mean, %.2f ms worst, %lu late.\n",
+	       ticks,
+	       total_time / (double) ticks / 1e6,
+	       worst_time / 1e6,
+	       late_ticks);
+}
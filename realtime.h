@@ -0,0 +1,15 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+/** The length of a real-time tick (one turn), in milliseconds. */
+#define REALTIME_TICK_MS 125
+
+/** The number of keypresses which can be waiting at once. */
+#define INPUT_QUEUE_SIZE 16
+
+void realtime_tick_start(void);
+void realtime_tick_end(void);
+int input_next(void);
+void realtime_report(void);
+
+#endif /* REALTIME_H */
@@ -0,0 +1,360 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "regions.h"
+#include "utils.h"
+
+/** The neighbours of a cell. */
+static const int neighbours[8][2] = {
+	{0, -1}, {0, 1}, {-1, 0}, {1, 0},
+	{-1, -1}, {1, -1}, {-1, 1}, {1, 1}
+};
+
+/**
+ * The cluster a cell is in.
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ */
+static unsigned int cluster_of(unsigned int x, unsigned int y) {
+	return (x / CLUSTER_WIDTH) * CLUSTERS_Y + (y / CLUSTER_HEIGHT);
+}
+
+/**
+ * Join two regions, if they aren't already.
+ * @param graph The graph
+ * @param a One region
+ * @param b The other
+ */
+static void join(RegionGraph * graph, unsigned short a, unsigned short b) {
+	Region * region = &graph->regions[a];
+
+	for(unsigned int i = 0; i < region->num_neighbours; i++) {
+		if(region->neighbours[i] == b) {
+			return;
+		}
+	}
+
+	if(region->num_neighbours == region->capacity) {
+		region->capacity = (region->capacity == 0) ? 4 : region->capacity * 2;
+		region->neighbours = xrealloc(region->neighbours, region->capacity, unsigned short);
+	}
+	region->neighbours[region->num_neighbours ++] = b;
+}
+
+/**
+ * Remove a region from another's neighbours.
+ * @param graph The graph
+ * @param a The region to remove from
+ * @param b The region to remove
+ */
+static void unjoin(RegionGraph * graph, unsigned short a, unsigned short b) {
+	Region * region = &graph->regions[a];
+
+	for(unsigned int i = 0; i < region->num_neighbours; i++) {
+		if(region->neighbours[i] == b) {
+			region->neighbours[i] = region->neighbours[-- region->num_neighbours];
+			return;
+		}
+	}
+}
+
+/**
+ * Work out the regions of a cluster from scratch, and join them to
+ * the regions of the clusters around.
+ * @param level The level
+ * @param cluster The cluster
+ */
+static void label_cluster(Level * level, unsigned int cluster) {
+	RegionGraph * graph = level->regions;
+	unsigned int first = cluster * CLUSTER_REGIONS;
+
+	/* Forget the cluster's old regions */
+	for(unsigned int id = first; id < first + CLUSTER_REGIONS; id++) {
+		Region * region = &graph->regions[id];
+		if(!region->used) {
+			continue;
+		}
+
+		for(unsigned int i = 0; i < region->num_neighbours; i++) {
+			unjoin(graph, region->neighbours[i], id);
+		}
+		xfree(region->neighbours);
+		memset(region, 0, sizeof(Region));
+	}
+
+	unsigned int minx = (cluster / CLUSTERS_Y) * CLUSTER_WIDTH;
+	unsigned int miny = (cluster % CLUSTERS_Y) * CLUSTER_HEIGHT;
+	unsigned int maxx = (minx + CLUSTER_WIDTH < LEVELWIDTH) ? minx + CLUSTER_WIDTH : LEVELWIDTH;
+	unsigned int maxy = (miny + CLUSTER_HEIGHT < LEVELHEIGHT) ? miny + CLUSTER_HEIGHT : LEVELHEIGHT;
+
+	for(unsigned int x = minx; x < maxx; x++) {
+		for(unsigned int y = miny; y < maxy; y++) {
+			graph->region[x][y] = NO_REGION;
+		}
+	}
+
+	/* Flood fill each region within the cluster */
+	unsigned int stack[CLUSTER_WIDTH * CLUSTER_HEIGHT];
+	unsigned int next_id = first;
+
+	for(unsigned int x = minx; x < maxx; x++) {
+		for(unsigned int y = miny; y < maxy; y++) {
+			if(level->cells[x][y]->solid || graph->region[x][y] != NO_REGION) {
+				continue;
+			}
+
+			unsigned short id = next_id ++;
+			Region * region = &graph->regions[id];
+			unsigned int sumx = 0, sumy = 0;
+			unsigned int top = 0;
+
+			region->used = true;
+			graph->region[x][y] = id;
+			stack[top++] = x * LEVELHEIGHT + y;
+
+			while(top > 0) {
+				unsigned int cx = stack[--top] / LEVELHEIGHT;
+				unsigned int cy = stack[top] % LEVELHEIGHT;
+
+				region->size ++;
+				sumx += cx;
+				sumy += cy;
+
+				for(unsigned int i = 0; i < 8; i++) {
+					int nx = cx + neighbours[i][0];
+					int ny = cy + neighbours[i][1];
+
+					if(nx >= (int) minx && ny >= (int) miny && nx < (int) maxx && ny < (int) maxy &&
+					   !level->cells[nx][ny]->solid && graph->region[nx][ny] == NO_REGION) {
+						graph->region[nx][ny] = id;
+						stack[top++] = nx * LEVELHEIGHT + ny;
+					}
+				}
+			}
+
+			region->centrex = sumx / region->size;
+			region->centrey = sumy / region->size;
+		}
+	}
+
+	/* Join them to whatever they touch in the clusters around */
+	for(unsigned int x = minx; x < maxx; x++) {
+		for(unsigned int y = miny; y < maxy; y++) {
+			unsigned short id = graph->region[x][y];
+			if(id == NO_REGION) {
+				continue;
+			}
+
+			for(unsigned int i = 0; i < 8; i++) {
+				int nx = x + neighbours[i][0];
+				int ny = y + neighbours[i][1];
+
+				if(nx < 0 || ny < 0 || nx >= LEVELWIDTH || ny >= LEVELHEIGHT ||
+				   cluster_of(nx, ny) == cluster || graph->region[nx][ny] == NO_REGION) {
+					continue;
+				}
+
+				join(graph, id, graph->region[nx][ny]);
+				join(graph, graph->region[nx][ny], id);
+			}
+		}
+	}
+}
+
+/**
+ * Build the region graph of a newly generated level.
+ * @param level The level
+ */
+void build_regions(Level * level) {
+	free_regions(level);
+	level->regions = xalloc(RegionGraph);
+
+	for(unsigned int x = 0; x < LEVELWIDTH; x++) {
+		for(unsigned int y = 0; y < LEVELHEIGHT; y++) {
+			level->regions->region[x][y] = NO_REGION;
+		}
+	}
+
+	for(unsigned int cluster = 0; cluster < CLUSTERS_X * CLUSTERS_Y; cluster++) {
+		label_cluster(level, cluster);
+	}
+}
+
+/**
+ * Update the region graph after a cell has been dug out. Only the
+ * cluster containing the cell is worked out again.
+ * @param level The level
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ */
+void regions_dug(Level * level, unsigned int x, unsigned int y) {
+	if(level->regions != NULL) {
+		label_cluster(level, cluster_of(x, y));
+	}
+}
+
+/**
+ * Free the region graph of a level.
+ * @param level The level
+ */
+void free_regions(Level * level) {
+	if(level->regions == NULL) {
+		return;
+	}
+
+	for(unsigned int id = 0; id < NUM_REGIONS; id++) {
+		xfree(level->regions->regions[id].neighbours);
+	}
+	xfree(level->regions);
+}
+
+/**
+ * Find the cheapest route of regions from one to another, by
+ * Dijkstra's algorithm over the graph (which is small enough that
+ * the next region to settle is simply searched for). The distance
+ * between regions is that between their middles.
+ * @param graph The graph
+ * @param from The region to start in
+ * @param to The region to get to
+ * @param on_route Set for each region on the route
+ * @return false if there is no route
+ */
+static bool find_route(const RegionGraph * graph,
+                       unsigned short from, unsigned short to,
+                       bool on_route[NUM_REGIONS]) {
+	int dist[NUM_REGIONS];
+	unsigned short parent[NUM_REGIONS];
+	bool done[NUM_REGIONS];
+
+	for(unsigned int id = 0; id < NUM_REGIONS; id++) {
+		dist[id] = INT_MAX;
+		done[id] = false;
+		on_route[id] = false;
+	}
+	dist[from] = 0;
+
+	for(;;) {
+		unsigned int best = NO_REGION;
+		for(unsigned int id = 0; id < NUM_REGIONS; id++) {
+			if(!done[id] && dist[id] != INT_MAX &&
+			   (best == NO_REGION || dist[id] < dist[best])) {
+				best = id;
+			}
+		}
+
+		if(best == NO_REGION) {
+			return false;
+		} else if(best == to) {
+			break;
+		}
+
+		done[best] = true;
+
+		const Region * region = &graph->regions[best];
+		for(unsigned int i = 0; i < region->num_neighbours; i++) {
+			unsigned short next = region->neighbours[i];
+			int dx = abs((int) region->centrex - (int) graph->regions[next].centrex);
+			int dy = abs((int) region->centrey - (int) graph->regions[next].centrey);
+			int cost = dist[best] + ((dx > dy) ? dx : dy) + 1;
+
+			if(cost < dist[next]) {
+				dist[next] = cost;
+				parent[next] = best;
+			}
+		}
+	}
+
+	for(unsigned short id = to; id != from; id = parent[id]) {
+		on_route[id] = true;
+	}
+	on_route[from] = true;
+
+	return true;
+}
+
+/**
+ * What a corridor search needs to know.
+ */
+typedef struct Corridor {
+	const RegionGraph * graph; /**< The graph */
+	const bool * on_route;     /**< The regions the corridor runs through */
+} Corridor;
+
+/**
+ * Walking, but only through the regions of a corridor.
+ * @param level The level
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ * @param data The Corridor
+ */
+static int corridor_cost(Level * level, unsigned int x, unsigned int y, void * data) {
+	const Corridor * corridor = (const Corridor *) data;
+	unsigned short id = corridor->graph->region[x][y];
+
+	if(id == NO_REGION || !corridor->on_route[id]) {
+		return PATH_BLOCKED;
+	}
+
+	return path_walk_cost(level, x, y, NULL);
+}
+
+/**
+ * Find a walking path, like find_path, but planning it over the
+ * region graph first: if the regions aren't connected there's no
+ * search at all, and if they are, the search is kept to the regions
+ * on the route. Paths with other costs (such as digging) are left to
+ * find_path.
+ * @param finder The storage to search with
+ * @param level The level
+ * @param startx The X to start from
+ * @param starty The Y to start from
+ * @param goalx The X to get to
+ * @param goaly The Y to get to
+ * @param options How to search (NULL for orthogonal walking)
+ * @param steps Where to write the steps of the path (may be NULL)
+ * @param max_steps The most steps to write
+ * @return The length of the whole path, or PATH_NONE if there isn't one
+ */
+unsigned int find_long_path(PathFinder * finder, Level * level,
+                            unsigned int startx, unsigned int starty,
+                            unsigned int goalx, unsigned int goaly,
+                            const PathOptions * options,
+                            PathStep * steps, unsigned int max_steps) {
+	const RegionGraph * graph = level->regions;
+
+	if(graph == NULL ||
+	   (options != NULL && options->cost != NULL && options->cost != &path_walk_cost)) {
+		return find_path(finder, level, startx, starty, goalx, goaly, options, steps, max_steps);
+	}
+
+	unsigned short from = graph->region[startx][starty];
+	unsigned short to = graph->region[goalx][goaly];
+
+	if(from == NO_REGION || to == NO_REGION || from == to) {
+		return find_path(finder, level, startx, starty, goalx, goaly, options, steps, max_steps);
+	}
+
+	/* Regions join diagonally, so no route means no path of any kind */
+	bool on_route[NUM_REGIONS];
+	if(!find_route(graph, from, to, on_route)) {
+		return PATH_NONE;
+	}
+
+	Corridor corridor = {.graph = graph, .on_route = on_route};
+	PathOptions refine = {
+		.diagonal = (options != NULL) && options->diagonal,
+		.cost = &corridor_cost,
+		.data = &corridor,
+		.min_cost = 1
+	};
+
+	unsigned int length = find_path(finder, level, startx, starty, goalx, goaly, &refine, steps, max_steps);
+
+	/* Without diagonals the corridor may be cut off; search it all */
+	if(length == PATH_NONE) {
+		length = find_path(finder, level, startx, starty, goalx, goaly, options, steps, max_steps);
+	}
+
+	return length;
+}
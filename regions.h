@@ -0,0 +1,67 @@
+#ifndef REGIONS_H
+#define REGIONS_H
+
+#include <stdbool.h>
+
+#include "level.h"
+#include "astar.h"
+
+/** The width of a cluster of cells. */
+#define CLUSTER_WIDTH 10
+
+/** The height of a cluster of cells. */
+#define CLUSTER_HEIGHT 10
+
+/** The number of clusters across a level. */
+#define CLUSTERS_X ((LEVELWIDTH + CLUSTER_WIDTH - 1) / CLUSTER_WIDTH)
+
+/** The number of clusters down a level. */
+#define CLUSTERS_Y ((LEVELHEIGHT + CLUSTER_HEIGHT - 1) / CLUSTER_HEIGHT)
+
+/** The most regions a cluster can be split into (cells are joined
+ * diagonally, so a cluster can't have more than a quarter of its
+ * cells in separate regions). */
+#define CLUSTER_REGIONS ((CLUSTER_WIDTH + 1) / 2 * ((CLUSTER_HEIGHT + 1) / 2))
+
+/** The number of region ids in a level. */
+#define NUM_REGIONS (CLUSTERS_X * CLUSTERS_Y * CLUSTER_REGIONS)
+
+/** The region of a cell which isn't in one (it's solid). */
+#define NO_REGION 0xFFFF
+
+/**
+ * A region: a set of open cells within a cluster, connected within it
+ * (including diagonally).
+ */
+typedef struct Region {
+	bool used;               /**< Whether the id is in use. */
+	unsigned int size;       /**< The number of cells. */
+	unsigned int centrex;    /**< The X of the middle (roughly). */
+	unsigned int centrey;    /**< The Y of the middle (roughly). */
+	unsigned short * neighbours; /**< The regions next to this one. */
+	unsigned int num_neighbours; /**< The number of neighbours. */
+	unsigned int capacity;   /**< The size of neighbours. */
+} Region;
+
+/**
+ * The region graph of a level. The level is cut into fixed clusters,
+ * and each cluster into the regions it contains; regions are joined
+ * where their cells touch across cluster borders. Long paths are
+ * planned over this graph, then refined on the grid within the
+ * regions the route passes through.
+ */
+typedef struct RegionGraph {
+	unsigned short region[LEVELWIDTH][LEVELHEIGHT]; /**< The region of each cell. */
+	Region regions[NUM_REGIONS]; /**< The regions, by id. */
+} RegionGraph;
+
+void build_regions(Level * level);
+void regions_dug(Level * level, unsigned int x, unsigned int y);
+void free_regions(Level * level);
+unsigned int find_long_path(PathFinder * finder, Level * level,
+                            unsigned int startx, unsigned int starty,
+                            unsigned int goalx, unsigned int goaly,
+                            const PathOptions * options,
+                            PathStep * steps, unsigned int max_steps);
+
+#endif /* REGIONS_H */
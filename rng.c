@@ -0,0 +1,94 @@
+#include <assert.h>
+
+#include "rng.h"
+
+/** The seed every stream is worked out from. */
+extern unsigned long game_seed;
+
+/**
+ * Scramble a number, so that seeds close together give states far
+ * apart (SplitMix64).
+ * @param x The number
+ */
+static uint64_t mix(uint64_t x) {
+	x += 0x9e3779b97f4a7c15ull;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	return x ^ (x >> 31);
+}
+
+/**
+ * Seed a generator.
+ * @param rng The generator
+ * @param seed The seed
+ * @param sequence Which of the sequences to draw from
+ */
+void rng_seed(Rng * rng, uint64_t seed, uint64_t sequence) {
+	rng->state = 0;
+	rng->inc = (sequence << 1) | 1;
+	rng_next(rng);
+	rng->state += seed;
+	rng_next(rng);
+}
+
+/**
+ * Seed a generator as one of the streams of the game.
+ * @param rng The generator
+ * @param stream The stream
+ * @param depth The depth of the level it belongs to (0 for those
+ * which belong to the game as a whole)
+ */
+void rng_stream(Rng * rng, enum RngStream stream, unsigned int depth) {
+	rng_seed(rng, mix(game_seed ^ mix(depth)), stream);
+}
+
+/**
+ * Seed a generator from another, for a draw to be made independently
+ * of (or on a different thread to) the one it came from.
+ * @param rng The generator to draw the seed from
+ * @param child The generator to seed
+ */
+void rng_split(Rng * rng, Rng * child) {
+	uint64_t seed = (uint64_t) rng_next(rng) << 32;
+	seed |= rng_next(rng);
+	uint64_t sequence = (uint64_t) rng_next(rng) << 32;
+	sequence |= rng_next(rng);
+	rng_seed(child, seed, sequence);
+}
+
+/**
+ * Draw a random number.
+ * @param rng The generator
+ * @return A number, uniform over all 32 bits
+ */
+uint32_t rng_next(Rng * rng) {
+	uint64_t old = rng->state;
+	rng->state = old * 6364136223846793005ull + rng->inc;
+
+	uint32_t shifted = (uint32_t) (((old >> 18) ^ old) >> 27);
+	uint32_t rot = (uint32_t) (old >> 59);
+	return (shifted >> rot) | (shifted << ((-rot) & 31));
+}
+
+/**
+ * Draw a random number below a bound.
+ * @param rng The generator
+ * @param bound The bound, which must be positive
+ * @return A number in [0, bound)
+ */
+unsigned int rng_below(Rng * rng, unsigned int bound) {
+	assert(bound > 0);
+
+	/* Multiply and shift, rather than take the remainder, so the low
+	   bits aren't favoured */
+	return (unsigned int) (((uint64_t) rng_next(rng) * bound) >> 32);
+}
+
+/**
+ * Draw a random number between 0 and 1.
+ * @param rng The generator
+ * @return A number in (0, 1]
+ */
+double rng_unit(Rng * rng) {
+	return (rng_next(rng) + 1.0) / 4294967296.0;
+}
@@ -0,0 +1,42 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/**
+ * The separate streams of random numbers. Each level has its own
+ * generation, AI, and combat streams, worked out from the game seed
+ * and its depth, so what happens in one doesn't change what's drawn
+ * from another: the same seed makes the same caves, however the
+ * fighting goes. The rest belong to the game as a whole.
+ */
+enum RngStream {
+	RNG_GEN,           /**< Building the level, and what turns up in it. */
+	RNG_AI,            /**< The decisions of its enemies. */
+	RNG_COMBAT,        /**< The outcomes of fights, digging, and the like. */
+	NUM_LEVEL_STREAMS,
+	RNG_CHARACTER = NUM_LEVEL_STREAMS, /**< Making up the player. */
+	RNG_AUTOPLAY       /**< The decisions of the autoplayer. */
+};
+
+/**
+ * A random number generator (PCG32): a 64-bit linear congruential
+ * state, output through a permutation. Different increments give
+ * independent sequences from the same seed.
+ */
+typedef struct Rng {
+	uint64_t state; /**< The state, advanced by each draw. */
+	uint64_t inc;   /**< The increment, which picks the sequence (always odd). */
+} Rng;
+
+/** Pointer to one of the streams of a level. */
+#define level_rng(L, S) (&(L)->rng[(S)])
+
+void rng_seed(Rng * rng, uint64_t seed, uint64_t sequence);
+void rng_stream(Rng * rng, enum RngStream stream, unsigned int depth);
+void rng_split(Rng * rng, Rng * child);
+uint32_t rng_next(Rng * rng);
+unsigned int rng_below(Rng * rng, unsigned int bound);
+double rng_unit(Rng * rng);
+
+#endif /* RNG_H */
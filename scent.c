@@ -0,0 +1,143 @@
+#include "scent.h"
+#include "mob.h"
+#include "utils.h"
+
+/** How loud each action is: fighting and digging carry furthest. */
+static const float action_noise[] = {
+	1.0f,  /* ACTION_WAIT */
+	1.0f,  /* ACTION_MOVE */
+	8.0f,  /* ACTION_ATTACK */
+	16.0f, /* ACTION_DIG */
+	1.0f,  /* ACTION_QUAFF */
+	1.0f   /* ACTION_EAT */
+};
+
+/**
+ * The scent map of a level, made if it doesn't have one.
+ * @param level The level
+ */
+static ScentMap * scent_map(Level * level) {
+	if(level->scent == NULL) {
+		level->scent = xalloc(ScentMap);
+		level->scent->epoch = level->terrain_epoch - 1;
+	}
+
+	return level->scent;
+}
+
+/**
+ * Note that the player has done something, which is as loud as the
+ * loudest thing they've done this turn.
+ * @param level The level the player is in
+ * @param action What they did
+ */
+void make_noise(Level * level, enum Action action) {
+	ScentMap * scent = scent_map(level);
+
+	if(action_noise[action] > scent->noise) {
+		scent->noise = action_noise[action];
+	}
+}
+
+/**
+ * Leave the player's scent and noise where they are, and spread and
+ * fade the field by a turn. The border of a level is always solid, so
+ * only the inside is worked out, and without any branching.
+ * @param level The level, which must have a player
+ */
+void spread_scent(Level * level) {
+	ScentMap * scent = scent_map(level);
+
+	if(scent->epoch != level->terrain_epoch) {
+		for(unsigned int x = 0; x < LEVELWIDTH; x++) {
+			for(unsigned int y = 0; y < LEVELHEIGHT; y++) {
+				scent->open[x][y] = level->cells[x][y]->solid ? 0.0f : 1.0f;
+			}
+		}
+		scent->epoch = level->terrain_epoch;
+	}
+
+	float (*from)[LEVELHEIGHT] = scent->field[scent->current];
+	float (*to)[LEVELHEIGHT] = scent->field[!scent->current];
+
+	unsigned int px = mob_xpos(level->player);
+	unsigned int py = mob_ypos(level->player);
+	if(scent->noise < 1.0f) {
+		scent->noise = 1.0f;
+	}
+	if(from[px][py] < scent->noise) {
+		from[px][py] = scent->noise;
+	}
+	scent->noise = 0.0f;
+
+	const float keep = SCENT_DECAY * (1.0f - SCENT_SPREAD);
+	const float share = SCENT_DECAY * SCENT_SPREAD / 4.0f;
+
+	for(unsigned int x = 1; x < LEVELWIDTH - 1; x++) {
+		const float * restrict left = from[x - 1];
+		const float * restrict middle = from[x];
+		const float * restrict right = from[x + 1];
+		const float * restrict open = scent->open[x];
+		float * restrict out = to[x];
+
+		for(unsigned int y = 1; y < LEVELHEIGHT - 1; y++) {
+			out[y] = open[y] * (keep * middle[y] +
+			                    share * (left[y] + right[y] + middle[y - 1] + middle[y + 1]));
+		}
+	}
+
+	scent->current = !scent->current;
+}
+
+/**
+ * Find the step towards the strongest scent next to a cell.
+ * @param level The level
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ * @param dx Set to the X offset of the step
+ * @param dy Set to the Y offset of the step
+ * @return false if there's no scent to follow from here
+ */
+bool scent_step(const Level * level, unsigned int x, unsigned int y, int * dx, int * dy) {
+	const ScentMap * scent = level->scent;
+
+	if(scent == NULL) {
+		return false;
+	}
+
+	const float (*field)[LEVELHEIGHT] = (const float (*)[LEVELHEIGHT]) scent->field[scent->current];
+	float best = field[x][y];
+
+	if(best < SCENT_FAINT) {
+		best = SCENT_FAINT;
+	}
+
+	bool found = false;
+	for(int xoff = -1; xoff <= 1; xoff++) {
+		for(int yoff = -1; yoff <= 1; yoff++) {
+			int nx = x + xoff;
+			int ny = y + yoff;
+
+			if(nx < 0 || ny < 0 || nx >= LEVELWIDTH || ny >= LEVELHEIGHT) {
+				continue;
+			}
+
+			if(field[nx][ny] > best) {
+				best = field[nx][ny];
+				*dx = xoff;
+				*dy = yoff;
+				found = true;
+			}
+		}
+	}
+
+	return found;
+}
+
+/**
+ * Free the scent map of a level.
+ * @param level The level
+ */
+void free_scent(Level * level) {
+	xfree(level->scent);
+}
@@ -0,0 +1,37 @@
+#ifndef SCENT_H
+#define SCENT_H
+
+#include <stdbool.h>
+
+#include "level.h"
+#include "schedule.h"
+
+/** The share of a cell's scent kept from one turn to the next. */
+#define SCENT_DECAY 0.95f
+
+/** The share of a cell's scent mixed with its neighbours each turn. */
+#define SCENT_SPREAD 0.6f
+
+/** The least scent which can be followed. */
+#define SCENT_FAINT 0.0001f
+
+/**
+ * The scent the player leaves, and the noise they make, spread over a
+ * level and fading away. Each turn the field is worked out afresh from
+ * the last into the other buffer, from each cell and its neighbours,
+ * with solid cells soaking it up.
+ */
+typedef struct ScentMap {
+	float field[2][LEVELWIDTH][LEVELHEIGHT]; /**< The current field and the next. */
+	unsigned int current;                    /**< Which field is current. */
+	float open[LEVELWIDTH][LEVELHEIGHT];     /**< 1 for open cells, 0 for solid ones. */
+	unsigned long epoch;                     /**< The terrain epoch open was worked out at. */
+	float noise;                             /**< How loud the player has been this turn. */
+} ScentMap;
+
+void make_noise(Level * level, enum Action action);
+void spread_scent(Level * level);
+bool scent_step(const Level * level, unsigned int x, unsigned int y, int * dx, int * dy);
+void free_scent(Level * level);
+
+#endif /* SCENT_H */
@@ -0,0 +1,214 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "schedule.h"
+#include "heap.h"
+#include "mob.h"
+#include "level.h"
+#include "enemy.h"
+#include "scent.h"
+#include "spatial.h"
+#include "utils.h"
+
+/**
+ * The energy cost of each action, indexed by enum Action. An ordinary
+ * action costs TURN_TICKS * NORMAL_SPEED.
+ */
+static const int action_costs[] = {
+	100, /* ACTION_WAIT */
+	100, /* ACTION_MOVE */
+	100, /* ACTION_ATTACK */
+	150, /* ACTION_DIG */
+	50,  /* ACTION_QUAFF */
+	100, /* ACTION_EAT */
+};
+
+/**
+ * Queue a mob to act as soon as it has the energy to. A mob in debt
+ * gains energy at its speed until it is out of debt, so the time it
+ * acts can be worked out now, and it costs nothing until then.
+ * @param mob The mob to schedule
+ */
+void schedule_mob(Mob * mob) {
+	Level * level = mob->level;
+	MobTable * table = &level->mobtable;
+	unsigned int row = mob->row;
+
+	int speed = (table->stats[row].speed == 0) ? 1 : (int) table->stats[row].speed;
+	unsigned long when = level->time;
+
+	if(table->energy[row] < 0) {
+		int ticks = (speed - 1 - table->energy[row]) / speed;
+		table->energy[row] += ticks * speed;
+		when += ticks;
+	}
+
+	table->ticket[row] = heap_push(&level->schedule, when, mob->id);
+}
+
+/**
+ * Record that a mob has done something during its turn. A turn can
+ * consist of several actions (digging into a wall and then moving
+ * into the hole, for example), and the costs add up.
+ * @param mob The mob
+ * @param action What the mob did
+ */
+void charge_action(Mob * mob, enum Action action) {
+	mob->level->mobtable.cost[mob->row] += action_costs[action];
+
+	if(mob == mob->level->player) {
+		make_noise(mob->level, action);
+	}
+}
+
+/**
+ * Pay for a mob's turn, and queue it to act again. A turn in which
+ * nothing was charged counts as waiting.
+ * @param mob The mob which has just acted
+ */
+void finish_action(Mob * mob) {
+	MobTable * table = &mob->level->mobtable;
+	unsigned int row = mob->row;
+
+	int cost = table->cost[row];
+	if(cost == 0) {
+		cost = action_costs[ACTION_WAIT];
+	}
+
+	table->energy[row] -= cost;
+	table->cost[row] = 0;
+
+	schedule_mob(mob);
+}
+
+/**
+ * Take the next mob which is due to act before a given time, and
+ * advance the level clock to the time it acts. Mobs which have died
+ * or left the level since being queued are skipped.
+ * @param level The level
+ * @param until The end of the period to take mobs from
+ * @return The mob, or NULL if no more mobs are due
+ */
+Mob * next_actor(Level * level, unsigned long until) {
+	HeapEntry entry;
+
+	while(heap_peek(&level->schedule, &entry) && entry.key < until) {
+		heap_pop(&level->schedule, NULL);
+
+		Mob * mob = mobtable_get(&level->mobtable, entry.value);
+		if(mob == NULL ||
+		   level->mobtable.ticket[mob->row] != entry.seq ||
+		   mob_health(mob) <= 0) {
+			continue;
+		}
+
+		if(entry.key > level->time) {
+			level->time = entry.key;
+		}
+
+		return mob;
+	}
+
+	return NULL;
+}
+
+/**
+ * The number of moves a mob could make in a period of time.
+ * @param mob The mob
+ * @param ticks The length of the period
+ */
+unsigned long moves_in(Mob * mob, unsigned long ticks) {
+	return (ticks * mob_stats(mob)->speed) / action_costs[ACTION_MOVE];
+}
+
+/**
+ * The distance between a mob and the player, counting diagonal steps
+ * as one.
+ * @param mob The mob
+ * @param player The player
+ */
+static unsigned int player_distance(Mob * mob, Mob * player) {
+	int dx = abs((int) mob_xpos(mob) - (int) mob_xpos(player));
+	int dy = abs((int) mob_ypos(mob) - (int) mob_ypos(player));
+	return (unsigned int) ((dx > dy) ? dx : dy);
+}
+
+/**
+ * Send a mob which is due to act to sleep, if it is only wandering and
+ * the player is far away. A dormant mob is taken off the schedule, so
+ * it costs nothing until the player comes near (see wake_nearby).
+ * @param mob The mob which is about to act
+ * @return true if the mob went dormant (and so shouldn't act)
+ */
+bool try_sleep(Mob * mob) {
+	Level * level = mob->level;
+
+	if(level->player == NULL || !is_wandering(mob) ||
+	   player_distance(mob, level->player) <= SLEEP_DISTANCE) {
+		return false;
+	}
+
+	level->mobtable.dormant[mob->row] = true;
+	level->mobtable.slept[mob->row] = level->time;
+	return true;
+}
+
+/**
+ * Wake a dormant mob, catching it up on the wandering it would have
+ * done while asleep in a single step, and queue it to act.
+ * @param mob The mob to wake
+ */
+static void wake_mob(Mob * mob) {
+	MobTable * table = &mob->level->mobtable;
+	unsigned int row = mob->row;
+
+	table->dormant[row] = false;
+	catch_up_wander(mob, moves_in(mob, mob->level->time - table->slept[row]));
+
+	table->energy[row] = 0;
+	table->cost[row] = 0;
+	schedule_mob(mob);
+}
+
+/**
+ * Wake every dormant mob near the player. This only looks at the
+ * buckets around the player, so it costs the same however many mobs
+ * are asleep elsewhere in the level.
+ * @param level The level
+ */
+void wake_nearby(Level * level) {
+	if(level->player == NULL) {
+		return;
+	}
+
+	MobTable * table = &level->mobtable;
+	/* There's at most one mob to a cell */
+	Mob * nearby[(2 * WAKE_DISTANCE + 1) * (2 * WAKE_DISTANCE + 1)];
+	unsigned int count = mobs_near(level,
+	                               mob_xpos(level->player), mob_ypos(level->player),
+	                               WAKE_DISTANCE, nearby, lengthof(nearby));
+
+	for(unsigned int i = 0; i < count; i++) {
+		if(table->dormant[nearby[i]->row]) {
+			wake_mob(nearby[i]);
+		}
+	}
+}
+
+/**
+ * Wake every dormant mob sharing a hunter's state, so that its whole
+ * pack joins in when it takes up the chase. This looks through every
+ * mob in the level, but only happens as a hunt starts.
+ * @param mob The hunter
+ */
+void wake_pack(Mob * mob) {
+	MobTable * table = &mob->level->mobtable;
+
+	for(unsigned int row = 0; row < table->count; row++) {
+		if(table->dormant[row] && table->ai[row] == AI_HUNTER &&
+		   table->mob[row]->data == mob->data) {
+			wake_mob(table->mob[row]);
+		}
+	}
+}
@@ -0,0 +1,34 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "mob.h"
+#include "level.h"
+
+/** The speed of an ordinary mob, in energy gained per tick. */
+#define NORMAL_SPEED 10
+
+/** The number of ticks in a turn: long enough for an ordinary mob to
+ * make one ordinary move. */
+#define TURN_TICKS 10
+
+/** Wandering mobs further than this from the player go dormant. */
+#define SLEEP_DISTANCE 16
+
+/** Dormant mobs this close to the player wake up. */
+#define WAKE_DISTANCE 12
+
+/**
+ * The things a mob can spend its energy on.
+ */
+enum Action { ACTION_WAIT, ACTION_MOVE, ACTION_ATTACK, ACTION_DIG, ACTION_QUAFF, ACTION_EAT };
+
+void schedule_mob(Mob * mob);
+void charge_action(Mob * mob, enum Action action);
+void finish_action(Mob * mob);
+Mob * next_actor(Level * level, unsigned long until);
+unsigned long moves_in(Mob * mob, unsigned long ticks);
+bool try_sleep(Mob * mob);
+void wake_nearby(Level * level);
+void wake_pack(Mob * mob);
+
+#endif /* SCHEDULE_H */
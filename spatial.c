@@ -0,0 +1,212 @@
+#include <stdlib.h>
+
+#include "spatial.h"
+#include "utils.h"
+
+/**
+ * The bucket a cell is in.
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ */
+static unsigned int bucket_of(unsigned int x, unsigned int y) {
+	return (x / BUCKET_SIZE) * BUCKETS_Y + (y / BUCKET_SIZE);
+}
+
+/**
+ * The distance between two cells, counting diagonal steps as one.
+ */
+static unsigned int distance(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) {
+	unsigned int dx = abs((int) x1 - (int) x2);
+	unsigned int dy = abs((int) y1 - (int) y2);
+	return (dx > dy) ? dx : dy;
+}
+
+/**
+ * The range of buckets covering the cells within a distance of one.
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ * @param radius The distance
+ * @param minbx Set to the first bucket column
+ * @param minby Set to the first bucket row
+ * @param maxbx Set to the last bucket column
+ * @param maxby Set to the last bucket row
+ */
+static void bucket_range(unsigned int x, unsigned int y, unsigned int radius,
+                         unsigned int * minbx, unsigned int * minby,
+                         unsigned int * maxbx, unsigned int * maxby) {
+	*minbx = (x < radius) ? 0 : (x - radius) / BUCKET_SIZE;
+	*minby = (y < radius) ? 0 : (y - radius) / BUCKET_SIZE;
+	*maxbx = (x + radius >= LEVELWIDTH) ? BUCKETS_X - 1 : (x + radius) / BUCKET_SIZE;
+	*maxby = (y + radius >= LEVELHEIGHT) ? BUCKETS_Y - 1 : (y + radius) / BUCKET_SIZE;
+}
+
+/**
+ * Note that a mob has been placed in a level.
+ * @param level The level
+ * @param id The mob
+ * @param x Its X
+ * @param y Its Y
+ */
+void spatial_add(Level * level, MobId id, unsigned int x, unsigned int y) {
+	if(level->spatial == NULL) {
+		level->spatial = xalloc(SpatialIndex);
+	}
+
+	Bucket * bucket = &level->spatial->buckets[bucket_of(x, y)];
+
+	if(bucket->count == bucket->capacity) {
+		bucket->capacity = (bucket->capacity == 0) ? 4 : bucket->capacity * 2;
+		bucket->mobs = xrealloc(bucket->mobs, bucket->capacity, MobId);
+	}
+	bucket->mobs[bucket->count ++] = id;
+}
+
+/**
+ * Note that a mob has left a level, or died.
+ * @param level The level
+ * @param id The mob
+ * @param x Its X
+ * @param y Its Y
+ */
+void spatial_remove(Level * level, MobId id, unsigned int x, unsigned int y) {
+	if(level->spatial == NULL) {
+		return;
+	}
+
+	Bucket * bucket = &level->spatial->buckets[bucket_of(x, y)];
+
+	for(unsigned int i = 0; i < bucket->count; i++) {
+		if(bucket->mobs[i] == id) {
+			bucket->mobs[i] = bucket->mobs[-- bucket->count];
+			return;
+		}
+	}
+}
+
+/**
+ * Note that a mob has moved within a level.
+ * @param level The level
+ * @param id The mob
+ * @param fromx The X it was at
+ * @param fromy The Y it was at
+ * @param tox The X it's at now
+ * @param toy The Y it's at now
+ */
+void spatial_move(Level * level, MobId id,
+                  unsigned int fromx, unsigned int fromy,
+                  unsigned int tox, unsigned int toy) {
+	if(bucket_of(fromx, fromy) != bucket_of(tox, toy)) {
+		spatial_remove(level, id, fromx, fromy);
+		spatial_add(level, id, tox, toy);
+	}
+}
+
+/**
+ * Find the mobs within a distance of a cell (counting diagonal steps
+ * as one), including any in the cell itself.
+ * @param level The level
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ * @param radius The distance
+ * @param found Where to write the mobs
+ * @param max_found The most mobs to write
+ * @return The number of mobs written
+ */
+unsigned int mobs_near(const Level * level,
+                       unsigned int x, unsigned int y, unsigned int radius,
+                       Mob ** found, unsigned int max_found) {
+	if(level->spatial == NULL) {
+		return 0;
+	}
+
+	unsigned int minbx, minby, maxbx, maxby;
+	unsigned int count = 0;
+
+	bucket_range(x, y, radius, &minbx, &minby, &maxbx, &maxby);
+
+	for(unsigned int bx = minbx; bx <= maxbx; bx++) {
+		for(unsigned int by = minby; by <= maxby; by++) {
+			const Bucket * bucket = &level->spatial->buckets[bx * BUCKETS_Y + by];
+
+			for(unsigned int i = 0; i < bucket->count && count < max_found; i++) {
+				Mob * mob = mobtable_get(&level->mobtable, bucket->mobs[i]);
+
+				if(mob != NULL && distance(x, y, mob_xpos(mob), mob_ypos(mob)) <= radius) {
+					found[count ++] = mob;
+				}
+			}
+		}
+	}
+
+	return count;
+}
+
+/**
+ * Find the nearest mob to a cell which matches a test. Buckets which
+ * can't hold anything nearer than the best so far are skipped.
+ * @param level The level
+ * @param x The X of the cell
+ * @param y The Y of the cell
+ * @param radius The furthest to look
+ * @param match The test (NULL to match anything)
+ * @param data Passed to the test
+ * @return The mob, or NULL if none is near enough
+ */
+Mob * nearest_mob(const Level * level,
+                  unsigned int x, unsigned int y, unsigned int radius,
+                  MobMatch match, void * data) {
+	if(level->spatial == NULL) {
+		return NULL;
+	}
+
+	unsigned int minbx, minby, maxbx, maxby;
+	unsigned int best_distance = radius + 1;
+	Mob * best = NULL;
+
+	bucket_range(x, y, radius, &minbx, &minby, &maxbx, &maxby);
+
+	for(unsigned int bx = minbx; bx <= maxbx; bx++) {
+		for(unsigned int by = minby; by <= maxby; by++) {
+			/* The nearest any cell of the bucket can be */
+			unsigned int nearx = (x < bx * BUCKET_SIZE) ? bx * BUCKET_SIZE
+				: (x >= (bx + 1) * BUCKET_SIZE) ? (bx + 1) * BUCKET_SIZE - 1 : x;
+			unsigned int neary = (y < by * BUCKET_SIZE) ? by * BUCKET_SIZE
+				: (y >= (by + 1) * BUCKET_SIZE) ? (by + 1) * BUCKET_SIZE - 1 : y;
+			if(distance(x, y, nearx, neary) >= best_distance) {
+				continue;
+			}
+
+			const Bucket * bucket = &level->spatial->buckets[bx * BUCKETS_Y + by];
+
+			for(unsigned int i = 0; i < bucket->count; i++) {
+				Mob * mob = mobtable_get(&level->mobtable, bucket->mobs[i]);
+				if(mob == NULL) {
+					continue;
+				}
+
+				unsigned int dist = distance(x, y, mob_xpos(mob), mob_ypos(mob));
+				if(dist < best_distance && (match == NULL || match(mob, data))) {
+					best = mob;
+					best_distance = dist;
+				}
+			}
+		}
+	}
+
+	return best;
+}
+
+/**
+ * Free the spatial index of a level.
+ * @param level The level
+ */
+void free_spatial(Level * level) {
+	if(level->spatial == NULL) {
+		return;
+	}
+
+	for(unsigned int i = 0; i < BUCKETS_X * BUCKETS_Y; i++) {
+		xfree(level->spatial->buckets[i].mobs);
+	}
+	xfree(level->spatial);
+}
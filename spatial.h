@@ -0,0 +1,56 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include <stdbool.h>
+
+#include "level.h"
+#include "mob.h"
+#include "mobtable.h"
+
+/** The width and height of a bucket, in cells. */
+#define BUCKET_SIZE 8
+
+/** The number of buckets across a level. */
+#define BUCKETS_X ((LEVELWIDTH + BUCKET_SIZE - 1) / BUCKET_SIZE)
+
+/** The number of buckets down a level. */
+#define BUCKETS_Y ((LEVELHEIGHT + BUCKET_SIZE - 1) / BUCKET_SIZE)
+
+/**
+ * Whether a mob is what a query is looking for.
+ */
+typedef bool (*MobMatch)(Mob * mob, void * data);
+
+/**
+ * The mobs in one square of the level.
+ */
+typedef struct Bucket {
+	MobId * mobs;          /**< The mobs. */
+	unsigned int count;    /**< The number of mobs. */
+	unsigned int capacity; /**< The size of mobs. */
+} Bucket;
+
+/**
+ * Where the mobs of a level are, for finding those near a point
+ * without going through them all: cells hold their occupant, and the
+ * level is cut into coarse buckets which hold the mobs within them,
+ * so only the buckets a query overlaps need looking at.
+ */
+typedef struct SpatialIndex {
+	Bucket buckets[BUCKETS_X * BUCKETS_Y]; /**< The buckets. */
+} SpatialIndex;
+
+void spatial_add(Level * level, MobId id, unsigned int x, unsigned int y);
+void spatial_remove(Level * level, MobId id, unsigned int x, unsigned int y);
+void spatial_move(Level * level, MobId id,
+                  unsigned int fromx, unsigned int fromy,
+                  unsigned int tox, unsigned int toy);
+unsigned int mobs_near(const Level * level,
+                       unsigned int x, unsigned int y, unsigned int radius,
+                       Mob ** found, unsigned int max_found);
+Mob * nearest_mob(const Level * level,
+                  unsigned int x, unsigned int y, unsigned int radius,
+                  MobMatch match, void * data);
+void free_spatial(Level * level);
+
+#endif /* SPATIAL_H */
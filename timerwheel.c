@@ -0,0 +1,108 @@
+#include <assert.h>
+#include <stddef.h>
+
+#include "timerwheel.h"
+
+/**
+ * Put a timer in the slot its time belongs in: the lowest level at
+ * which its time and the current time differ only in that level's
+ * digit. Timers too far away for any level to tell apart wait in the
+ * far list.
+ * @param wheel The wheel
+ * @param timer The timer (which is not in a slot)
+ */
+static void place(TimerWheel * wheel, Timer * timer) {
+	unsigned int top = WHEEL_BITS * WHEEL_LEVELS;
+	if((timer->due >> top) != (wheel->now >> top)) {
+		timer->head = &wheel->far;
+		list_push(timer->head, &timer->slot);
+		return;
+	}
+
+	unsigned int level = 0;
+	while(level < WHEEL_LEVELS - 1 &&
+	      (timer->due >> (WHEEL_BITS * (level + 1))) != (wheel->now >> (WHEEL_BITS * (level + 1)))) {
+		level ++;
+	}
+
+	unsigned int slot = (timer->due >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+	timer->head = &wheel->slots[level][slot];
+	list_push(timer->head, &timer->slot);
+}
+
+/**
+ * Add a timer to a wheel.
+ * @param wheel The wheel
+ * @param timer The timer (which must not be in a wheel)
+ * @param due When the timer fires, which is at the next advance at
+ *        the earliest
+ */
+void wheel_add(TimerWheel * wheel, Timer * timer, unsigned long due) {
+	assert(timer->head == NULL);
+
+	timer->due = (due <= wheel->now) ? wheel->now + 1 : due;
+	place(wheel, timer);
+}
+
+/**
+ * Take a timer out of whichever wheel it's in, if any.
+ * @param timer The timer
+ */
+void wheel_remove(Timer * timer) {
+	if(timer->head != NULL) {
+		list_drop(timer->head, &timer->slot);
+		timer->head = NULL;
+	}
+}
+
+/**
+ * Move the wheel on by one, bringing down the timers in any
+ * higher-level slots that have come round (and, when the whole wheel
+ * has, the far timers). The timers now due can then be taken with
+ * wheel_pop.
+ * @param wheel The wheel
+ */
+void wheel_advance(TimerWheel * wheel) {
+	wheel->now ++;
+
+	/* The far timers go first, as some may land in slots brought down
+	   below. Those still too far go back on a fresh list. */
+	if((wheel->now & ((1UL << (WHEEL_BITS * WHEEL_LEVELS)) - 1)) == 0) {
+		ListHead far = wheel->far;
+		wheel->far = (ListHead) {0};
+
+		list_foreach_safe(Timer, slot, timer, next, &far) {
+			list_drop(&far, &timer->slot);
+			place(wheel, timer);
+		}
+	}
+
+	for(unsigned int level = WHEEL_LEVELS - 1; level > 0; level--) {
+		if((wheel->now & ((1UL << (WHEEL_BITS * level)) - 1)) != 0) {
+			continue;
+		}
+
+		ListHead * head = &wheel->slots[level][(wheel->now >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)];
+		list_foreach_safe(Timer, slot, timer, next, head) {
+			list_drop(head, &timer->slot);
+			place(wheel, timer);
+		}
+	}
+}
+
+/**
+ * Take the next timer which is due now out of the wheel.
+ * @param wheel The wheel
+ * @return The timer, or NULL if there are no more due
+ */
+Timer * wheel_pop(TimerWheel * wheel) {
+	ListHead * head = &wheel->slots[0][wheel->now & (WHEEL_SLOTS - 1)];
+	Timer * timer = list_entry(Timer, slot, head->first);
+
+	if(timer != NULL) {
+		assert(timer->due == wheel->now);
+		wheel_remove(timer);
+	}
+
+	return timer;
+}
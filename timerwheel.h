@@ -0,0 +1,44 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include "list.h"
+
+/** The number of bits of the time each level of the wheel covers. */
+#define WHEEL_BITS 6
+
+/** The number of slots in each level of the wheel. */
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+
+/** The number of levels in the wheel. Timers further away than the
+ * wheel spans wait to one side until it comes round. */
+#define WHEEL_LEVELS 3
+
+/**
+ * A timer, to be embedded in whatever it is timing.
+ */
+typedef struct Timer {
+	List slot;       /**< The other timers in the same slot. */
+	ListHead * head; /**< The slot the timer is in (NULL if not in a wheel). */
+	unsigned long due; /**< The time the timer fires. */
+} Timer;
+
+/**
+ * A hierarchical timer wheel. Each level is a ring of slots, with
+ * each slot of a level spanning a whole turn of the level below;
+ * timers sit in the lowest level which can tell them apart from the
+ * current time, and are cascaded down as their time approaches, so
+ * adding and removing are constant time and advancing only looks at
+ * the timers which are due. A zeroed TimerWheel is empty, at time 0.
+ */
+typedef struct TimerWheel {
+	unsigned long now; /**< The current time. */
+	ListHead slots[WHEEL_LEVELS][WHEEL_SLOTS]; /**< The slots of each level. */
+	ListHead far; /**< Timers beyond the span of the wheel, placed again each time it comes round. */
+} TimerWheel;
+
+void wheel_add(TimerWheel * wheel, Timer * timer, unsigned long due);
+void wheel_remove(Timer * timer);
+void wheel_advance(TimerWheel * wheel);
+Timer * wheel_pop(TimerWheel * wheel);
+
+#endif /* TIMERWHEEL_H */
@@ -165,13 +165,14 @@ const void ** list_choice(bool nochoice,
 
 /**
  * Select a random value from a list
+ * @param rng The generator to draw from
  * @param choices NULL-terminates list of choices.
  */
-const void * random_choice(const void * choices[]) {
+const void * random_choice(Rng * rng, const void * choices[]) {
 	int num_choices;
 	for(num_choices = 0; choices[num_choices] != NULL; num_choices ++);
 	assert(num_choices != 0);
-	return choices[rand() % num_choices];
+	return choices[rng_below(rng, num_choices)];
 }
 
 /**
@@ -212,6 +213,20 @@ void * _xalloc(size_t size) {
 	return mem;
 }
 
+/**
+ * Resize allocated memory (which may be NULL) and immediately bail out
+ * if it fails. Unlike _xalloc, any new memory is not zeroed.
+ * @param ptr Memory to resize.
+ * @param size New size of the memory (in bytes).
+ * @return Resized memory.
+ * @note Do not use this directly, use the xrealloc macro instead.
+ */
+void * _xrealloc(void * ptr, size_t size) {
+	void * mem = realloc(ptr, size);
+	assert(mem != NULL);
+	return mem;
+}
+
 /**
  * Free a non-NULL pointer.
  * @param ptr Pointer to memory to free.
@@ -226,9 +241,10 @@ void _xfree(void ** ptr) {
 
 /**
  * A random distribution biased towards the end
+ * @param rng The generator to draw from
  * @param max Maximum random value
  */
-int biased_rand(int max) {
+int biased_rand(Rng * rng, int max) {
 	if(max == 0) {
 		return 0;
 	}
@@ -237,15 +253,15 @@ int biased_rand(int max) {
 	int midpoint = (max / 2) + (max % 2);
 	int out;
 
-	if(rand() % 4 == 0) {
+	if(rng_below(rng, 4) == 0) {
 		/* Choose from first half */
-		out = rand() % midpoint;
-	} else if(rand() % 5 < 2) {
+		out = rng_below(rng, midpoint);
+	} else if(rng_below(rng, 5) < 2) {
 		/* Choose from the third quarter */
-		out = (rand() % midpoint) + (midpoint / 2);
+		out = rng_below(rng, midpoint) + (midpoint / 2);
 	} else {
 		/* Choose from the final quarter */
-		out = (rand() % midpoint) + midpoint;
+		out = rng_below(rng, midpoint) + midpoint;
 	}
 
 	return (out > max) ? max : out;
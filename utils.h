@@ -1,6 +1,8 @@
 #ifndef _UTILS_H
 #define _UTILS_H
 
+#include "rng.h"
+
 /** The width of the screen, in characters. */
 #define SCREENWIDTH 80
 
@@ -13,6 +15,9 @@
 /** Handy calloc-like function using _xalloc. */
 #define xcalloc(S,T) _xalloc((S) * sizeof(T));
 
+/** Resize an array P to hold S elements of type T using _xrealloc. */
+#define xrealloc(P,S,T) _xrealloc((P), (S) * sizeof(T))
+
 /** Wrapper macro for _xfree to add the extra indirection. */
 #define xfree(P) _xfree((void **)&(P))
 
@@ -32,10 +37,11 @@ const void ** list_choice(bool nochoice,
                           bool empty,
                           const char * choices[],
                           const void * results[]);
-const void * random_choice(const void * choices[]);
+const void * random_choice(Rng * rng, const void * choices[]);
 void show_help();
 void * _xalloc(size_t size);
+void * _xrealloc(void * ptr, size_t size);
 void _xfree(void ** ptr);
-int biased_rand(int max);
+int biased_rand(Rng * rng, int max);
 
 #endif